@@ -0,0 +1,422 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTC3MF.h"
+#include "LTCFile.h"
+#include "LTCGraphView.h"
+#include "LTCNumber.h"
+#include "LTCStreamReader.h"
+#include "LTCStreamWriter.h"
+#include "LTCZip.h"
+
+#include <cstring>
+
+namespace LTC {
+
+  namespace {
+    const size_t kFlushSize = 1 << 20;
+    const char* kModelPart = "3D/3dmodel.model";
+    const char* kModelRelationship = "http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel";
+
+    const char* kContentTypes =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+      "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+      "<Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>"
+      "</Types>\n";
+
+    const char* kRelationships =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+      "<Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\" "
+      "Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/>"
+      "</Relationships>\n";
+
+    const char* kModelStart =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<model unit=\"millimeter\" xml:lang=\"en-US\" "
+      "xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\" "
+      "xmlns:b=\"http://schemas.microsoft.com/3dmanufacturing/beamlattice/2017/02\" "
+      "requiredextensions=\"b\">\n"
+      " <resources>\n";
+
+    bool writeEntry(LTCZipWriter& zip, const char* name, const char* text) {
+      return zip.beginEntry(name) && zip.write(text, strlen(text)) && zip.endEntry();
+    }
+
+    //! Tag or attribute name without its namespace prefix is name.
+    bool isLocal(const char* text, size_t length, const char* name) {
+      const char* colon = static_cast<const char*>(memchr(text, ':', length));
+      if ( colon ) {
+        length -= colon + 1 - text;
+        text = colon + 1;
+      }
+      return strlen(name) == length && strncmp(text, name, length) == 0;
+    }
+
+    bool isLocal(const LTCXmlTag& tag, const char* name) {
+      return isLocal(tag.mName, tag.mNameLength, name);
+    }
+
+    bool toDouble(const LTCXmlAttribute* attribute, double& value) {
+      return attribute &&
+        parseDouble(attribute->mValue, attribute->mValue + attribute->mValueLength, value) != nullptr;
+    }
+
+    bool toInt(const LTCXmlAttribute* attribute, int& value) {
+      return attribute &&
+        parseInt(attribute->mValue, attribute->mValue + attribute->mValueLength, value) != nullptr;
+    }
+
+    //! 3MF unit names, scale is what is left after the graph units (micron, meter).
+    LTCUnits parseUnits(const LTCXmlAttribute* attribute, double& scale) {
+      scale = 1.0;
+      if ( attribute ) {
+        if ( attribute->valueIs("micron") ) {
+          scale = 0.001;
+        }
+        else if ( attribute->valueIs("centimeter") ) {
+          return LTCUnits::CM;
+        }
+        else if ( attribute->valueIs("meter") ) {
+          //LTCUnits::M keeps the legacy scale of 100, not 1000
+          scale = 1000.0;
+        }
+        else if ( attribute->valueIs("inch") ) {
+          return LTCUnits::IN;
+        }
+        else if ( attribute->valueIs("foot") ) {
+          return LTCUnits::FT;
+        }
+      }
+      return LTCUnits::MM;
+    }
+
+    //! Vertices, triangles & beams of the object being read, in file units.
+    struct MeshObject {
+      int mID;
+      std::string mName;
+      std::vector<double> mX, mY, mZ, mRadius;
+      std::vector<Face> mFaces;
+      std::vector<Beam> mBeams;
+      double mLatticeRadius;
+
+      void clear() {
+        mID = 0;
+        mName = "no_name";
+        mX.clear();
+        mY.clear();
+        mZ.clear();
+        mRadius.clear();
+        mFaces.clear();
+        mBeams.clear();
+        mLatticeRadius = 0.0;
+      }
+    };
+  }
+
+  LTC_ERROR LTC3MF::write(const char* path,
+                          const std::vector<LTCGraphP>& graphs,
+                          double defaultRadius) {
+    auto file = openFile(path, "wb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+    LTCZipWriter zip(file);
+    LTCWriteOptions options;
+    options.mFloatFormat = LTCFloatFormat::SHORTEST;
+
+    bool ok = writeEntry(zip, "[Content_Types].xml", kContentTypes) &&
+      writeEntry(zip, "_rels/.rels", kRelationships) &&
+      zip.beginEntry(kModelPart);
+
+    std::string out;
+    out.reserve(kFlushSize + (1 << 12));
+    auto flushIfFull = [&](bool force) {
+      if ( ok && (force || out.size() >= kFlushSize) ) {
+        ok = zip.write(out.data(), out.size());
+        out.clear();
+      }
+    };
+    auto appendValue = [&](const char* name, double value, LTCNodePrecision precision) {
+      out += ' ';
+      out += name;
+      out += "=\"";
+      LTCStreamWriter::appendDouble(out, value, options, precision);
+      out += '\"';
+    };
+
+    out += kModelStart;
+    for ( size_t g = 0; g < graphs.size() && ok; g++ ) {
+      const auto& graph = *graphs[g];
+      size_t numOfNodes = graph.getNodeCount();
+      auto precision = graph.getNodePrecision();
+
+      double latticeRadius = defaultRadius;
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        double radius = graph.getNode(i).mRadius;
+        if ( radius > 0.0 ) {
+          latticeRadius = radius;
+          break;
+        }
+      }
+      //radius by node, nodes without one take the lattice radius
+      std::vector<double> radii(numOfNodes);
+
+      out += "  <object id=\"";
+      out += std::to_string(g + 1);
+      out += "\" type=\"model\" name=\"";
+      LTCStreamWriter::appendEscaped(out, graph.getName().c_str());
+      out += "\">\n   <mesh>\n    <vertices>\n";
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        auto node = graph.getNode(i);
+        radii[i] = node.mRadius > 0.0 ? node.mRadius : latticeRadius;
+        out += "     <vertex";
+        appendValue("x", node.mX, precision);
+        appendValue("y", node.mY, precision);
+        appendValue("z", node.mZ, precision);
+        out += "/>\n";
+        flushIfFull(false);
+      }
+      out += "    </vertices>\n    <triangles>\n";
+      auto isNode = [numOfNodes](int idx) {
+        return idx >= 0 && static_cast<size_t>(idx) < numOfNodes;
+      };
+      for ( auto& face : graph.getFaces() ) {
+        if ( !isNode(face.v0) || !isNode(face.v1) || !isNode(face.v2) ||
+            (face.v3 >= 0 && !isNode(face.v3)) ) {
+          continue;
+        }
+        int triangles[2][3] = { { face.v0, face.v1, face.v2 }, { face.v0, face.v2, face.v3 } };
+        for ( int t = 0; t < (face.v3 < 0 ? 1 : 2); t++ ) {
+          out += "     <triangle v1=\"";
+          out += std::to_string(triangles[t][0]);
+          out += "\" v2=\"";
+          out += std::to_string(triangles[t][1]);
+          out += "\" v3=\"";
+          out += std::to_string(triangles[t][2]);
+          out += "\"/>\n";
+        }
+        flushIfFull(false);
+      }
+      out += "    </triangles>\n";
+
+      const auto& beams = graph.getBeams();
+      if ( !beams.empty() ) {
+        out += "    <b:beamlattice";
+        appendValue("radius", latticeRadius, precision);
+        out += " minlength=\"0.0001\" cap=\"sphere\">\n     <b:beams>\n";
+        for ( auto& beam : beams ) {
+          if ( beam.mNode1Idx == beam.mNode2Idx ||
+              !isNode(beam.mNode1Idx) || !isNode(beam.mNode2Idx) ) {
+            continue;
+          }
+          //r1 defaults to the lattice radius, r2 to r1
+          double r1 = radii[beam.mNode1Idx];
+          double r2 = radii[beam.mNode2Idx];
+          out += "      <b:beam v1=\"";
+          out += std::to_string(beam.mNode1Idx);
+          out += "\" v2=\"";
+          out += std::to_string(beam.mNode2Idx);
+          out += '\"';
+          if ( r1 != latticeRadius ) {
+            appendValue("r1", r1, precision);
+          }
+          if ( r2 != r1 ) {
+            appendValue("r2", r2, precision);
+          }
+          out += "/>\n";
+          flushIfFull(false);
+        }
+        out += "     </b:beams>\n    </b:beamlattice>\n";
+      }
+      out += "   </mesh>\n  </object>\n";
+    }
+    out += " </resources>\n <build>\n";
+    for ( size_t g = 0; g < graphs.size(); g++ ) {
+      out += "  <item objectid=\"";
+      out += std::to_string(g + 1);
+      out += "\"/>\n";
+    }
+    out += " </build>\n</model>\n";
+    flushIfFull(true);
+
+    ok = ok && zip.endEntry() && zip.finish();
+    if ( fclose(file) != 0 ) {
+      ok = false;
+    }
+    return ok ? LTC_ERROR::OK : LTC_ERROR::LTC_FILE_WRITE_ERROR;
+  }
+
+  LTC_ERROR LTC3MF::read(const char* path, std::vector<LTCGraphP>& graphs) {
+    LTC_ERROR err;
+    auto file = LTCMappedFile::open(path, err);
+    if ( !file ) {
+      return err;
+    }
+    LTCZipReader zip;
+    err = zip.open(file->data(), static_cast<size_t>(file->size()));
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+
+    //the start part is named by the package relationships
+    std::string modelPart = kModelPart;
+    std::vector<char> text;
+    auto rels = zip.find("_rels/.rels");
+    if ( rels && zip.read(*rels, text) == LTC_ERROR::OK ) {
+      LTCXmlScanner scanner(text.data(), text.size());
+      LTCXmlTag tag;
+      while ( scanner.next(tag) ) {
+        auto type = tag.find("Type");
+        auto target = tag.find("Target");
+        if ( isLocal(tag, "Relationship") && type && target && type->valueIs(kModelRelationship) ) {
+          modelPart = LTCStreamReader::decodeValue(*target);
+          break;
+        }
+      }
+    }
+    auto model = zip.find(modelPart);
+    if ( !model ) {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE;
+    }
+    err = zip.read(*model, text);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+    return readModel(text.data(), text.size(), graphs);
+  }
+
+  LTC_ERROR LTC3MF::readModel(const char* text, size_t numOfBytes,
+                              std::vector<LTCGraphP>& graphs) {
+    LTCXmlScanner scanner(text, numOfBytes);
+    LTCXmlTag tag;
+    LTCUnits units = LTCUnits::MM;
+    double scale = 1.0;
+    MeshObject object;
+    object.clear();
+    bool inObject = false;
+    bool foundLattice = false;
+
+    while ( scanner.next(tag) ) {
+      if ( tag.mKind == LTCXmlTag::END ) {
+        if ( !inObject || !isLocal(tag, "object") ) {
+          continue;
+        }
+        inObject = false;
+        if ( object.mBeams.empty() && object.mFaces.empty() ) {
+          continue;
+        }
+        auto graph = LTCGraph::create(object.mName, object.mID, units);
+        graph->reserve(object.mX.size(), object.mBeams.size(), object.mFaces.size());
+        graph->addNodes(object.mX, object.mY, object.mZ, object.mRadius);
+        graph->addBeams(object.mBeams);
+        graph->addFaces(object.mFaces);
+        graphs.push_back(graph);
+        foundLattice = true;
+        continue;
+      }
+
+      if ( isLocal(tag, "model") ) {
+        units = parseUnits(tag.find("unit"), scale);
+      }
+      else if ( isLocal(tag, "object") ) {
+        object.clear();
+        inObject = tag.mKind == LTCXmlTag::START;
+        toInt(tag.find("id"), object.mID);
+        auto name = tag.find("name");
+        if ( name ) {
+          object.mName = LTCStreamReader::decodeValue(*name);
+        }
+      }
+      else if ( !inObject ) {
+        continue;
+      }
+      else if ( isLocal(tag, "vertex") ) {
+        double v[3] = { 0.0, 0.0, 0.0 };
+        if ( !toDouble(tag.find("x"), v[0]) || !toDouble(tag.find("y"), v[1]) ||
+            !toDouble(tag.find("z"), v[2]) ) {
+          return LTC_ERROR::XML_ERROR_PARSING_ATTRIBUTE;
+        }
+        object.mX.push_back(v[0] * scale);
+        object.mY.push_back(v[1] * scale);
+        object.mZ.push_back(v[2] * scale);
+        object.mRadius.push_back(-1.0);
+      }
+      else if ( isLocal(tag, "triangle") ) {
+        Face face;
+        face.v3 = -1;
+        int numOfVertices = static_cast<int>(object.mX.size());
+        if ( !toInt(tag.find("v1"), face.v0) || !toInt(tag.find("v2"), face.v1) ||
+            !toInt(tag.find("v3"), face.v2) ||
+            face.v0 < 0 || face.v0 >= numOfVertices ||
+            face.v1 < 0 || face.v1 >= numOfVertices ||
+            face.v2 < 0 || face.v2 >= numOfVertices ) {
+          return LTC_ERROR::XML_ERROR_PARSING_ATTRIBUTE;
+        }
+        object.mFaces.push_back(face);
+      }
+      else if ( isLocal(tag, "beamlattice") ) {
+        if ( toDouble(tag.find("radius"), object.mLatticeRadius) ) {
+          object.mLatticeRadius *= scale;
+        }
+      }
+      else if ( isLocal(tag, "beam") ) {
+        Beam beam;
+        int numOfVertices = static_cast<int>(object.mX.size());
+        if ( !toInt(tag.find("v1"), beam.mNode1Idx) || !toInt(tag.find("v2"), beam.mNode2Idx) ||
+            beam.mNode1Idx < 0 || beam.mNode1Idx >= numOfVertices ||
+            beam.mNode2Idx < 0 || beam.mNode2Idx >= numOfVertices ) {
+          return LTC_ERROR::XML_ERROR_PARSING_ATTRIBUTE;
+        }
+        double r1 = object.mLatticeRadius, r2;
+        if ( toDouble(tag.find("r1"), r1) ) {
+          r1 *= scale;
+        }
+        r2 = r1;
+        if ( toDouble(tag.find("r2"), r2) ) {
+          r2 *= scale;
+        }
+        //the first beam end at a node sets its radius
+        double& radius1 = object.mRadius[beam.mNode1Idx];
+        double& radius2 = object.mRadius[beam.mNode2Idx];
+        if ( radius1 < 0.0 ) {
+          radius1 = r1;
+        }
+        if ( radius2 < 0.0 ) {
+          radius2 = r2;
+        }
+        object.mBeams.push_back(beam);
+      }
+    }
+    if ( scanner.getError() != LTC_ERROR::OK ) {
+      return scanner.getError();
+    }
+    return foundLattice ? LTC_ERROR::OK : LTC_ERROR::LTC_NO_LATTICE;
+  }
+
+}//namespace LTC
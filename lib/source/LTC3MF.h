@@ -0,0 +1,72 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCModel.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! LTC3MF
+  /*!
+  Reads & writes 3MF packages using the Beam Lattice extension, the node,
+  beam & radius model printers slice directly without a triangle mesh.
+
+  Each graph is one mesh object: nodes are its vertices, beams its
+  b:beams with the node radii as r1 / r2 & faces its triangles (quads are
+  split in two). Everything is written in millimeters into a stored
+  (uncompressed) ZIP, see LTCZipWriter. Nodes without a radius take the
+  lattice radius, which is the first node radius found or defaultRadius.
+  Degenerate beams (n1 == n2) are left out, 3MF forbids them, as are
+  beams & faces with a node index out of range. Rib
+  orientation has no 3MF equivalent & is not written.
+
+  Reading takes the model part named by the package relationships, stored
+  or deflated. Every mesh object with beams or triangles becomes a graph
+  named after the object, with the object id as graph id, in the file's
+  units (micron & meter are converted to MM). A node's radius is that of
+  the first beam end referencing it, -1 if no beam does. Components &
+  build transforms are ignored.
+  */
+  class LTC3MF {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    static LTC_ERROR write(const char* path,
+                           const std::vector<LTCGraphP>& graphs,
+                           double defaultRadius = 0.5);
+    static LTC_ERROR read(const char* path, std::vector<LTCGraphP>& graphs);
+
+    //! Parses the XML of a 3D model part.
+    static LTC_ERROR readModel(const char* text, size_t numOfBytes,
+                               std::vector<LTCGraphP>& graphs);
+  };
+
+}//namespace LTC
@@ -0,0 +1,108 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCAdjacency.h"
+#include "LTCParallel.h"
+
+
+namespace LTC {
+
+  namespace {
+    //below this a single thread is quicker than scanning the beams again
+    const size_t kMinBeamsPerThread = 1 << 16;
+
+    inline bool isValid(int node, size_t numOfNodes) {
+      return node >= 0 && static_cast<size_t>(node) < numOfNodes;
+    }
+  }
+
+  std::shared_ptr<LTCAdjacency> LTCAdjacency::create(size_t numOfNodes,
+                                                     LTCSpan<const Beam> beams,
+                                                     unsigned int numOfThreads) {
+    std::shared_ptr<LTCAdjacency> adjacency(new LTCAdjacency());
+    adjacency->mOffsets.assign(numOfNodes + 1, 0);
+    //every thread scans all beams but fills only the rows of its own node
+    //range, so no writes are shared & rows come out in beam order
+    numOfThreads = resolveThreadCount(numOfThreads);
+    size_t numOfRanges = beams.size() < kMinBeamsPerThread ? 1 : numOfThreads;
+    auto rangeStart = [&](size_t r) {
+      return numOfNodes * r / numOfRanges;
+    };
+    std::vector<size_t> next;
+    parallelFor(numOfRanges, numOfThreads, [&](size_t r) {
+      adjacency->build(beams, rangeStart(r), rangeStart(r + 1), COUNT, next);
+    });
+    auto& offsets = adjacency->mOffsets;
+    for ( size_t i = 0; i < numOfNodes; i++ ) {
+      offsets[i + 1] += offsets[i];
+    }
+
+    adjacency->mNeighbors.resize(offsets.back());
+    adjacency->mBeamIndices.resize(offsets.back());
+    next.assign(offsets.begin(), offsets.end() - 1);
+    parallelFor(numOfRanges, numOfThreads, [&](size_t r) {
+      adjacency->build(beams, rangeStart(r), rangeStart(r + 1), FILL, next);
+    });
+    return adjacency;
+  }
+
+  void LTCAdjacency::build(LTCSpan<const Beam> beams, size_t firstNode, size_t lastNode,
+                           Pass pass, std::vector<size_t>& next) {
+    size_t numOfNodes = getNodeCount();
+    //only rows in [firstNode, lastNode) are touched, so ranges can run side by side
+    auto owns = [&](int node) {
+      return static_cast<size_t>(node) >= firstNode && static_cast<size_t>(node) < lastNode;
+    };
+    for ( size_t i = 0; i < beams.size(); i++ ) {
+      auto& b = beams[i];
+      if ( !isValid(b.mNode1Idx, numOfNodes) || !isValid(b.mNode2Idx, numOfNodes) ) {
+        continue;
+      }
+      if ( owns(b.mNode1Idx) ) {
+        if ( pass == COUNT ) {
+          mOffsets[b.mNode1Idx + 1]++;
+        }
+        else {
+          size_t at = next[b.mNode1Idx]++;
+          mNeighbors[at] = b.mNode2Idx;
+          mBeamIndices[at] = static_cast<int>(i);
+        }
+      }
+      if ( owns(b.mNode2Idx) ) {
+        if ( pass == COUNT ) {
+          mOffsets[b.mNode2Idx + 1]++;
+        }
+        else {
+          size_t at = next[b.mNode2Idx]++;
+          mNeighbors[at] = b.mNode1Idx;
+          mBeamIndices[at] = static_cast<int>(i);
+        }
+      }
+    }
+  }
+
+}//namespace LTC
@@ -0,0 +1,85 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCSpan.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCAdjacency
+  /*!
+  Compressed sparse row adjacency of a graph's beams. The beams at node i
+  are entries [mOffsets[i], mOffsets[i + 1]) of mNeighbors (the node at
+  the other end) & mBeamIndices (the index into LTCGraph::getBeams()),
+  in beam order. Every beam shows up at both of its nodes, so a beam from
+  a node to itself shows up twice there; beams with a node outside
+  [0, numOfNodes) are left out.
+
+  Built in O(N + E). With several threads each one owns a range of nodes
+  & reads all beams, but only writes its own rows; the random writes,
+  which dominate, are what gets split. LTCGraph::getAdjacency keeps one
+  per graph.
+  */
+  class LTCAdjacency {
+  public:
+    //! Builds on numOfThreads threads (0 = hardware threads), same result on any count.
+    static std::shared_ptr<LTCAdjacency> create(size_t numOfNodes,
+                                                LTCSpan<const Beam> beams,
+                                                unsigned int numOfThreads = 0);
+
+    size_t getNodeCount()const { return mOffsets.size() - 1; }
+    size_t getDegree(size_t node)const { return mOffsets[node + 1] - mOffsets[node]; }
+
+    LTCSpan<const int> getNeighbors(size_t node)const {
+      return LTCSpan<const int>(mNeighbors.data() + mOffsets[node], getDegree(node));
+    }
+    LTCSpan<const int> getBeamIndices(size_t node)const {
+      return LTCSpan<const int>(mBeamIndices.data() + mOffsets[node], getDegree(node));
+    }
+
+    const std::vector<size_t>& getOffsets()const { return mOffsets; }
+    const std::vector<int>& getNeighbors()const { return mNeighbors; }
+    const std::vector<int>& getBeamIndices()const { return mBeamIndices; }
+
+  private:
+    enum Pass {
+      COUNT = 0,
+      FILL = 1
+    };
+    void build(LTCSpan<const Beam> beams, size_t firstNode, size_t lastNode,
+               Pass pass, std::vector<size_t>& next);
+
+    std::vector<size_t> mOffsets;
+    std::vector<int> mNeighbors;
+    std::vector<int> mBeamIndices;
+  };
+
+}//namespace LTC
@@ -0,0 +1,647 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCBeamBVH.h"
+#include "LTCParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace LTC {
+
+  namespace {
+    typedef LTCBeamBVH::Box Box;
+    typedef LTCBeamBVH::TreeNode TreeNode;
+
+    const int kNumOfBins = 16;
+    const uint32_t kMaxLeafSize = 4;
+    //ranges at least this long are bounded & binned on several threads
+    const size_t kParallelRange = 1 << 16;
+    const size_t kBlockSize = 1 << 14;
+    const double kInfinity = std::numeric_limits<double>::infinity();
+    //box bounds are only pruned when clearly beyond, distances to a beam
+    //& to its box round differently
+    const double kSlack = 1.0 + 1e-9;
+
+    struct Point {
+      double v[3];
+    };
+
+    double dot(const double a[3], const double b[3]) {
+      return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    Box emptyBox() {
+      Box box;
+      for ( int i = 0; i < 3; i++ ) {
+        box.mMin[i] = kInfinity;
+        box.mMax[i] = -kInfinity;
+      }
+      return box;
+    }
+
+    void grow(Box& box, const Box& other) {
+      for ( int i = 0; i < 3; i++ ) {
+        box.mMin[i] = std::min(box.mMin[i], other.mMin[i]);
+        box.mMax[i] = std::max(box.mMax[i], other.mMax[i]);
+      }
+    }
+
+    void grow(Box& box, const Point& p) {
+      for ( int i = 0; i < 3; i++ ) {
+        box.mMin[i] = std::min(box.mMin[i], p.v[i]);
+        box.mMax[i] = std::max(box.mMax[i], p.v[i]);
+      }
+    }
+
+    double area(const Box& box) {
+      double d[3];
+      for ( int i = 0; i < 3; i++ ) {
+        d[i] = box.mMax[i] - box.mMin[i];
+        if ( d[i] < 0.0 ) {
+          return 0.0;
+        }
+      }
+      return 2.0 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+    }
+
+    double squaredDistance(const Box& box, const double p[3]) {
+      double sum = 0.0;
+      for ( int i = 0; i < 3; i++ ) {
+        double d = std::max(std::max(box.mMin[i] - p[i], p[i] - box.mMax[i]), 0.0);
+        sum += d * d;
+      }
+      return sum;
+    }
+
+    //entry & exit of a ray through box, false if it misses within [0, tMax]
+    bool intersect(const Box& box, const double origin[3], const double inverse[3],
+                   double tMax, double& tNear) {
+      double t0 = 0.0;
+      double t1 = tMax;
+      for ( int i = 0; i < 3; i++ ) {
+        double a = (box.mMin[i] - origin[i]) * inverse[i];
+        double b = (box.mMax[i] - origin[i]) * inverse[i];
+        if ( a > b ) {
+          std::swap(a, b);
+        }
+        //NaN from 0 * inf leaves the bound as it was
+        t0 = a > t0 ? a : t0;
+        t1 = b < t1 ? b : t1;
+        if ( t0 > t1 ) {
+          return false;
+        }
+      }
+      tNear = t0;
+      return true;
+    }
+
+    double sign(double value) {
+      return value > 0.0 ? 1.0 : (value < 0.0 ? -1.0 : 0.0);
+    }
+
+    struct Bins {
+      Box mBoxes[3][kNumOfBins];
+      size_t mCounts[3][kNumOfBins];
+
+      void clear() {
+        for ( int axis = 0; axis < 3; axis++ ) {
+          for ( int b = 0; b < kNumOfBins; b++ ) {
+            mBoxes[axis][b] = emptyBox();
+            mCounts[axis][b] = 0;
+          }
+        }
+      }
+    };
+
+    //! Builder
+    /*!
+    Binned SAH over primitive boxes & centroids; the primitive indices are
+    reordered in place so every node covers a contiguous range.
+    */
+    struct Builder {
+      const std::vector<Box>& mBoxes;
+      const std::vector<Point>& mCentroids;
+      std::vector<uint32_t>& mPrimitives;
+      unsigned int mNumOfThreads;
+
+      struct Item {
+        uint32_t mNode;
+        size_t mFirst;
+        size_t mCount;
+        Box mCentroidBox;
+      };
+
+      //box of the primitives & of their centroids
+      void bound(size_t first, size_t count, Box& box, Box& centroidBox)const {
+        box = emptyBox();
+        centroidBox = emptyBox();
+        if ( count < kParallelRange || mNumOfThreads == 1 ) {
+          for ( size_t i = first; i < first + count; i++ ) {
+            grow(box, mBoxes[mPrimitives[i]]);
+            grow(centroidBox, mCentroids[mPrimitives[i]]);
+          }
+          return;
+        }
+        size_t numOfBlocks = (count + kBlockSize - 1) / kBlockSize;
+        std::vector<Box> boxes(numOfBlocks, emptyBox());
+        std::vector<Box> centroidBoxes(numOfBlocks, emptyBox());
+        parallelFor(numOfBlocks, mNumOfThreads, [&](size_t block) {
+          size_t begin = first + block * kBlockSize;
+          size_t end = std::min(begin + kBlockSize, first + count);
+          for ( size_t i = begin; i < end; i++ ) {
+            grow(boxes[block], mBoxes[mPrimitives[i]]);
+            grow(centroidBoxes[block], mCentroids[mPrimitives[i]]);
+          }
+        });
+        for ( size_t block = 0; block < numOfBlocks; block++ ) {
+          grow(box, boxes[block]);
+          grow(centroidBox, centroidBoxes[block]);
+        }
+      }
+
+      int binOf(const Point& centroid, int axis, const Box& centroidBox)const {
+        double extent = centroidBox.mMax[axis] - centroidBox.mMin[axis];
+        int bin = static_cast<int>((centroid.v[axis] - centroidBox.mMin[axis]) / extent * kNumOfBins);
+        return std::min(std::max(bin, 0), kNumOfBins - 1);
+      }
+
+      void binRange(size_t begin, size_t end, const Box& centroidBox, Bins& bins)const {
+        for ( size_t i = begin; i < end; i++ ) {
+          uint32_t primitive = mPrimitives[i];
+          for ( int axis = 0; axis < 3; axis++ ) {
+            if ( centroidBox.mMax[axis] > centroidBox.mMin[axis] ) {
+              int bin = binOf(mCentroids[primitive], axis, centroidBox);
+              grow(bins.mBoxes[axis][bin], mBoxes[primitive]);
+              bins.mCounts[axis][bin]++;
+            }
+          }
+        }
+      }
+
+      void bin(size_t first, size_t count, const Box& centroidBox, Bins& bins)const {
+        bins.clear();
+        if ( count < kParallelRange || mNumOfThreads == 1 ) {
+          binRange(first, first + count, centroidBox, bins);
+          return;
+        }
+        size_t numOfBlocks = (count + kBlockSize - 1) / kBlockSize;
+        std::vector<Bins> blockBins(numOfBlocks);
+        parallelFor(numOfBlocks, mNumOfThreads, [&](size_t block) {
+          size_t begin = first + block * kBlockSize;
+          blockBins[block].clear();
+          binRange(begin, std::min(begin + kBlockSize, first + count), centroidBox, blockBins[block]);
+        });
+        for ( auto& other : blockBins ) {
+          for ( int axis = 0; axis < 3; axis++ ) {
+            for ( int b = 0; b < kNumOfBins; b++ ) {
+              grow(bins.mBoxes[axis][b], other.mBoxes[axis][b]);
+              bins.mCounts[axis][b] += other.mCounts[axis][b];
+            }
+          }
+        }
+      }
+
+      //! Partitions [first, first + count) at mid, false if it should stay a leaf.
+      bool split(size_t first, size_t count, const Box& box, const Box& centroidBox,
+                 size_t& mid)const {
+        if ( count <= 1 ) {
+          return false;
+        }
+        Bins bins;
+        bin(first, count, centroidBox, bins);
+
+        //cost of a split relative to the leaf cost count * area(box)
+        int bestAxis = -1;
+        int bestSplit = 0;
+        double bestCost = kInfinity;
+        for ( int axis = 0; axis < 3; axis++ ) {
+          if ( !(centroidBox.mMax[axis] > centroidBox.mMin[axis]) ) {
+            continue;
+          }
+          double rightCosts[kNumOfBins];
+          Box right = emptyBox();
+          size_t rightCount = 0;
+          for ( int b = kNumOfBins - 1; b > 0; b-- ) {
+            grow(right, bins.mBoxes[axis][b]);
+            rightCount += bins.mCounts[axis][b];
+            rightCosts[b] = rightCount ? area(right) * rightCount : kInfinity;
+          }
+          Box left = emptyBox();
+          size_t leftCount = 0;
+          for ( int b = 1; b < kNumOfBins; b++ ) {
+            grow(left, bins.mBoxes[axis][b - 1]);
+            leftCount += bins.mCounts[axis][b - 1];
+            double cost = leftCount ? area(left) * leftCount + rightCosts[b] : kInfinity;
+            if ( cost < bestCost ) {
+              bestCost = cost;
+              bestAxis = axis;
+              bestSplit = b;
+            }
+          }
+        }
+
+        if ( bestAxis < 0 ) {
+          //all centroids coincide, only split to keep leaves small
+          if ( count <= kMaxLeafSize ) {
+            return false;
+          }
+          mid = first + count / 2;
+          return true;
+        }
+        if ( count <= kMaxLeafSize && bestCost >= area(box) * count ) {
+          return false;
+        }
+        auto begin = mPrimitives.begin() + first;
+        auto middle = std::partition(begin, begin + count, [&](uint32_t primitive) {
+          return binOf(mCentroids[primitive], bestAxis, centroidBox) < bestSplit;
+        });
+        mid = middle - mPrimitives.begin();
+        return true;
+      }
+
+      //! Splits item, appending its children to nodes & returning them in children.
+      bool expand(std::vector<TreeNode>& nodes, const Item& item, Item children[2])const {
+        size_t mid;
+        TreeNode& node = nodes[item.mNode];
+        if ( !split(item.mFirst, item.mCount, node.mBox, item.mCentroidBox, mid) ) {
+          node.mIndex = static_cast<uint32_t>(item.mFirst);
+          node.mCount = static_cast<uint32_t>(item.mCount);
+          return false;
+        }
+        auto left = static_cast<uint32_t>(nodes.size());
+        node.mIndex = left;
+        node.mCount = 0;
+        nodes.resize(nodes.size() + 2);
+        size_t ranges[2][2] = { { item.mFirst, mid - item.mFirst },
+                                { mid, item.mFirst + item.mCount - mid } };
+        for ( int c = 0; c < 2; c++ ) {
+          children[c].mNode = left + c;
+          children[c].mFirst = ranges[c][0];
+          children[c].mCount = ranges[c][1];
+          bound(children[c].mFirst, children[c].mCount, nodes[left + c].mBox, children[c].mCentroidBox);
+        }
+        return true;
+      }
+
+      //! Builds the whole subtree under item.mNode.
+      void buildSubtree(std::vector<TreeNode>& nodes, const Item& root)const {
+        std::vector<Item> stack(1, root);
+        while ( !stack.empty() ) {
+          Item item = stack.back();
+          stack.pop_back();
+          Item children[2];
+          if ( expand(nodes, item, children) ) {
+            stack.push_back(children[1]);
+            stack.push_back(children[0]);
+          }
+        }
+      }
+    };
+  }
+
+  std::shared_ptr<LTCBeamBVH> LTCBeamBVH::create(const LTCGraph& graph,
+                                                 unsigned int numOfThreads) {
+    std::shared_ptr<LTCBeamBVH> bvh(new LTCBeamBVH());
+    numOfThreads = resolveThreadCount(numOfThreads);
+    auto& beams = graph.getBeams();
+    size_t numOfNodes = graph.getNodeCount();
+    size_t numOfBeams = beams.size();
+
+    //capsules, their boxes & centroids
+    bvh->mCapsules.resize(numOfBeams);
+    std::vector<Box> boxes(numOfBeams);
+    std::vector<Point> centroids(numOfBeams);
+    size_t numOfBlocks = (numOfBeams + kBlockSize - 1) / kBlockSize;
+    parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+      size_t end = std::min((block + 1) * kBlockSize, numOfBeams);
+      for ( size_t i = block * kBlockSize; i < end; i++ ) {
+        auto& capsule = bvh->mCapsules[i];
+        int n1 = beams[i].mNode1Idx;
+        int n2 = beams[i].mNode2Idx;
+        capsule.mValid = n1 >= 0 && n2 >= 0 &&
+          static_cast<size_t>(n1) < numOfNodes && static_cast<size_t>(n2) < numOfNodes;
+        if ( !capsule.mValid ) {
+          continue;
+        }
+        Node a = graph.getNode(n1);
+        Node b = graph.getNode(n2);
+        double pa[3] = { a.mX, a.mY, a.mZ };
+        double pb[3] = { b.mX, b.mY, b.mZ };
+        capsule.mRadiusA = std::max(a.mRadius, 0.0);
+        capsule.mRadiusB = std::max(b.mRadius, 0.0);
+        for ( int k = 0; k < 3; k++ ) {
+          capsule.mA[k] = pa[k];
+          capsule.mB[k] = pb[k];
+          boxes[i].mMin[k] = std::min(pa[k] - capsule.mRadiusA, pb[k] - capsule.mRadiusB);
+          boxes[i].mMax[k] = std::max(pa[k] + capsule.mRadiusA, pb[k] + capsule.mRadiusB);
+          centroids[i].v[k] = 0.5 * (boxes[i].mMin[k] + boxes[i].mMax[k]);
+        }
+      }
+    });
+    for ( size_t i = 0; i < numOfBeams; i++ ) {
+      if ( bvh->mCapsules[i].mValid ) {
+        bvh->mPrimitives.push_back(static_cast<uint32_t>(i));
+      }
+    }
+    if ( bvh->mPrimitives.empty() ) {
+      return bvh;
+    }
+
+    Builder builder = { boxes, centroids, bvh->mPrimitives, numOfThreads };
+    auto& tree = bvh->mTree;
+    tree.resize(1);
+    Builder::Item root = { 0, 0, bvh->mPrimitives.size(), Box() };
+    builder.bound(0, root.mCount, tree[0].mBox, root.mCentroidBox);
+
+    //split the top of the tree here until there is enough work for every
+    //thread, then build the subtrees below side by side
+    size_t grain = numOfThreads == 1 ? root.mCount
+                                     : std::max<size_t>(root.mCount / (numOfThreads * 8), 1024);
+    std::vector<Builder::Item> work(1, root);
+    std::vector<Builder::Item> subtrees;
+    while ( !work.empty() ) {
+      auto item = work.back();
+      work.pop_back();
+      Builder::Item children[2];
+      if ( item.mCount <= grain ) {
+        subtrees.push_back(item);
+      }
+      else if ( builder.expand(tree, item, children) ) {
+        work.push_back(children[1]);
+        work.push_back(children[0]);
+      }
+    }
+
+    std::vector<std::vector<TreeNode>> subtreeNodes(subtrees.size());
+    parallelFor(subtrees.size(), numOfThreads, [&](size_t s) {
+      auto& nodes = subtreeNodes[s];
+      nodes.push_back(tree[subtrees[s].mNode]);
+      auto item = subtrees[s];
+      item.mNode = 0;
+      builder.buildSubtree(nodes, item);
+    });
+
+    //splice, local node 0 replaces the subtree's root, the rest is appended
+    for ( size_t s = 0; s < subtrees.size(); s++ ) {
+      auto& nodes = subtreeNodes[s];
+      auto base = static_cast<uint32_t>(tree.size()) - 1;
+      for ( auto& node : nodes ) {
+        if ( node.mCount == 0 ) {
+          node.mIndex += base;
+        }
+      }
+      tree[subtrees[s].mNode] = nodes[0];
+      tree.insert(tree.end(), nodes.begin() + 1, nodes.end());
+    }
+    return bvh;
+  }
+
+  double LTCBeamBVH::getDistance(int beam, const double point[3])const {
+    auto& c = mCapsules[beam];
+    if ( !c.mValid ) {
+      return kInfinity;
+    }
+    double ba[3], pa[3], pb[3];
+    for ( int k = 0; k < 3; k++ ) {
+      ba[k] = c.mB[k] - c.mA[k];
+      pa[k] = point[k] - c.mA[k];
+      pb[k] = point[k] - c.mB[k];
+    }
+    double l2 = dot(ba, ba);
+    double rr = c.mRadiusA - c.mRadiusB;
+    double a2 = l2 - rr * rr;
+    if ( a2 <= 0.0 ) {
+      //one sphere holds the other (or the beam has no length)
+      return std::min(std::sqrt(dot(pa, pa)) - c.mRadiusA,
+                      std::sqrt(dot(pb, pb)) - c.mRadiusB);
+    }
+
+    //exact distance to a round cone, see iquilezles.org "distance functions"
+    double y = dot(pa, ba);
+    double z = y - l2;
+    double q[3];
+    for ( int k = 0; k < 3; k++ ) {
+      q[k] = pa[k] * l2 - ba[k] * y;
+    }
+    double x2 = dot(q, q);
+    double y2 = y * y * l2;
+    double z2 = z * z * l2;
+    double k = sign(rr) * rr * rr * x2;
+    if ( sign(z) * a2 * z2 > k ) {
+      return std::sqrt(x2 + z2) / l2 - c.mRadiusB;
+    }
+    if ( sign(y) * a2 * y2 < k ) {
+      return std::sqrt(x2 + y2) / l2 - c.mRadiusA;
+    }
+    return (std::sqrt(x2 * a2 / l2) + y * rr) / l2 - c.mRadiusA;
+  }
+
+  double LTCBeamBVH::rayHit(uint32_t beam, const double origin[3], const double direction[3])const {
+    if ( getDistance(beam, origin) <= 0.0 ) {
+      return 0.0;
+    }
+    auto& c = mCapsules[beam];
+    double ba[3], oa[3], ob[3];
+    for ( int k = 0; k < 3; k++ ) {
+      ba[k] = c.mB[k] - c.mA[k];
+      oa[k] = origin[k] - c.mA[k];
+      ob[k] = origin[k] - c.mB[k];
+    }
+    double ra = c.mRadiusA;
+    double rb = c.mRadiusB;
+    double rr = ra - rb;
+    double m0 = dot(ba, ba);
+    double m1 = dot(ba, oa);
+    double m2 = dot(ba, direction);
+    double m3 = dot(direction, oa);
+    double m5 = dot(oa, oa);
+    double m6 = dot(ob, direction);
+    double m7 = dot(ob, ob);
+
+    //the cone between the spheres, it holds both so its first hit counts
+    //if it lands between the tangent circles (iquilezles.org "intersectors")
+    double d2 = m0 - rr * rr;
+    if ( d2 > 0.0 ) {
+      double k2 = d2 - m2 * m2;
+      double k1 = d2 * m3 - m1 * m2 + m2 * rr * ra;
+      double k0 = d2 * m5 - m1 * m1 + m1 * rr * ra * 2.0 - m0 * ra * ra;
+      double h = k1 * k1 - k0 * k2;
+      if ( h < 0.0 ) {
+        return kInfinity;
+      }
+      if ( k2 != 0.0 ) {
+        double t = (-std::sqrt(h) - k1) / k2;
+        double y = m1 - ra * rr + t * m2;
+        if ( y > 0.0 && y < d2 ) {
+          return t >= 0.0 ? t : kInfinity;
+        }
+      }
+    }
+
+    //otherwise the ray enters through one of the spheres
+    double t = kInfinity;
+    double h1 = m3 * m3 - m5 + ra * ra;
+    double h2 = m6 * m6 - m7 + rb * rb;
+    if ( h1 > 0.0 ) {
+      t = std::min(t, -m3 - std::sqrt(h1));
+    }
+    if ( h2 > 0.0 ) {
+      t = std::min(t, -m6 - std::sqrt(h2));
+    }
+    return t >= 0.0 ? t : kInfinity;
+  }
+
+  void LTCBeamBVH::findWithin(const double point[3], double distance,
+                              std::vector<int>& beams)const {
+    beams.clear();
+    if ( mTree.empty() ) {
+      return;
+    }
+    double limit = std::max(distance, 0.0);
+    std::vector<uint32_t> stack(1, 0);
+    while ( !stack.empty() ) {
+      auto& node = mTree[stack.back()];
+      stack.pop_back();
+      if ( squaredDistance(node.mBox, point) > limit * limit * kSlack ) {
+        continue;
+      }
+      if ( node.mCount == 0 ) {
+        stack.push_back(node.mIndex + 1);
+        stack.push_back(node.mIndex);
+        continue;
+      }
+      for ( uint32_t i = node.mIndex; i < node.mIndex + node.mCount; i++ ) {
+        if ( getDistance(mPrimitives[i], point) <= distance ) {
+          beams.push_back(static_cast<int>(mPrimitives[i]));
+        }
+      }
+    }
+    std::sort(beams.begin(), beams.end());
+  }
+
+  void LTCBeamBVH::findNearest(const double point[3], size_t k,
+                               std::vector<LTCBeamHit>& hits)const {
+    hits.clear();
+    if ( mTree.empty() || k == 0 ) {
+      return;
+    }
+    auto closer = [](const LTCBeamHit& a, const LTCBeamHit& b) {
+      return a.mDistance < b.mDistance || (a.mDistance == b.mDistance && a.mBeam < b.mBeam);
+    };
+    //hits is kept as a max heap of the best k so far
+    typedef std::pair<double, uint32_t> Entry; //squared box distance, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    queue.push(Entry(squaredDistance(mTree[0].mBox, point), 0));
+    while ( !queue.empty() ) {
+      auto entry = queue.top();
+      queue.pop();
+      if ( hits.size() == k ) {
+        //inside a box the bound is 0 while hits may be negative
+        double worst = hits.front().mDistance;
+        if ( entry.first > 0.0 && (worst < 0.0 || entry.first > worst * worst * kSlack) ) {
+          break;
+        }
+      }
+      auto& node = mTree[entry.second];
+      if ( node.mCount == 0 ) {
+        for ( uint32_t c = node.mIndex; c < node.mIndex + 2; c++ ) {
+          queue.push(Entry(squaredDistance(mTree[c].mBox, point), c));
+        }
+        continue;
+      }
+      for ( uint32_t i = node.mIndex; i < node.mIndex + node.mCount; i++ ) {
+        LTCBeamHit hit = { static_cast<int>(mPrimitives[i]), getDistance(mPrimitives[i], point) };
+        if ( hits.size() < k ) {
+          hits.push_back(hit);
+          std::push_heap(hits.begin(), hits.end(), closer);
+        }
+        else if ( closer(hit, hits.front()) ) {
+          std::pop_heap(hits.begin(), hits.end(), closer);
+          hits.back() = hit;
+          std::push_heap(hits.begin(), hits.end(), closer);
+        }
+      }
+    }
+    std::sort_heap(hits.begin(), hits.end(), closer);
+  }
+
+  bool LTCBeamBVH::raycast(const double origin[3], const double direction[3],
+                           double maxDistance, LTCBeamHit& hit)const {
+    double length = std::sqrt(dot(direction, direction));
+    if ( mTree.empty() || length == 0.0 ) {
+      return false;
+    }
+    double unit[3], inverse[3];
+    for ( int k = 0; k < 3; k++ ) {
+      unit[k] = direction[k] / length;
+      inverse[k] = 1.0 / unit[k];
+    }
+
+    hit.mBeam = -1;
+    hit.mDistance = maxDistance;
+    double tNear;
+    std::vector<uint32_t> stack;
+    if ( intersect(mTree[0].mBox, origin, inverse, hit.mDistance, tNear) ) {
+      stack.push_back(0);
+    }
+    while ( !stack.empty() ) {
+      auto& node = mTree[stack.back()];
+      stack.pop_back();
+      if ( node.mCount == 0 ) {
+        //visit the nearer child first
+        double t[2];
+        bool hits[2];
+        for ( int c = 0; c < 2; c++ ) {
+          hits[c] = intersect(mTree[node.mIndex + c].mBox, origin, inverse, hit.mDistance, t[c]);
+        }
+        int first = hits[1] && (!hits[0] || t[1] < t[0]) ? 1 : 0;
+        if ( hits[1 - first] ) {
+          stack.push_back(node.mIndex + 1 - first);
+        }
+        if ( hits[first] ) {
+          stack.push_back(node.mIndex + first);
+        }
+        continue;
+      }
+      for ( uint32_t i = node.mIndex; i < node.mIndex + node.mCount; i++ ) {
+        double t = rayHit(mPrimitives[i], origin, unit);
+        //misses come back as kInfinity, which maxDistance = inf would let through
+        if ( t < kInfinity && t <= hit.mDistance && (t < hit.mDistance || hit.mBeam < 0 ||
+                                    static_cast<int>(mPrimitives[i]) < hit.mBeam) ) {
+          hit.mBeam = static_cast<int>(mPrimitives[i]);
+          hit.mDistance = t;
+        }
+      }
+    }
+    return hit.mBeam >= 0;
+  }
+
+}//namespace LTC
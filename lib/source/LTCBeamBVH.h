@@ -0,0 +1,119 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+#include "LTCGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCBeamHit
+  /*!
+  A beam found by an LTCBeamBVH query & its distance: to the beam's
+  surface for point queries (negative inside), along the ray for raycast.
+  */
+  struct LTCBeamHit {
+    int mBeam;
+    double mDistance;
+  };
+
+  //! LTCBeamBVH
+  /*!
+  Bounding volume hierarchy over the beams of a graph for proximity &
+  picking queries. A beam is the convex hull of the spheres at its two
+  nodes (a capsule that tapers when the radii differ); nodes without a
+  radius count as points. Beams with a node index out of range are left
+  out. Distances are exact.
+
+  The tree is built top down with a binned SAH. Large nodes near the root
+  are binned in parallel, then the subtrees below are built on separate
+  threads. Queries are const & may run concurrently.
+
+  The BVH copies what it needs, it doesn't follow later changes to the graph.
+  */
+  class LTCBeamBVH {
+  public:
+    static std::shared_ptr<LTCBeamBVH> create(const LTCGraph& graph,
+                                              unsigned int numOfThreads = 0);
+
+    //! Beams whose surface is within distance of point, in beam order.
+    void findWithin(const double point[3], double distance,
+                    std::vector<int>& beams)const;
+
+    //! The k beams closest to point, nearest first.
+    void findNearest(const double point[3], size_t k,
+                     std::vector<LTCBeamHit>& hits)const;
+
+    //! First beam a ray enters within maxDistance, direction needn't be unit length.
+    /*!
+    mDistance is measured along the normalized direction; a ray starting
+    inside a beam hits it at 0. Returns false if nothing is hit.
+    */
+    bool raycast(const double origin[3], const double direction[3],
+                 double maxDistance, LTCBeamHit& hit)const;
+
+    //! Signed distance from point to the surface of beam, negative inside.
+    double getDistance(int beam, const double point[3])const;
+
+    size_t getBeamCount()const { return mCapsules.size(); }
+    size_t getTreeSize()const { return mTree.size(); }
+
+    struct Box {
+      double mMin[3];
+      double mMax[3];
+    };
+
+    //! A tree node: mCount primitives from mIndex on, or children mIndex & mIndex + 1.
+    struct TreeNode {
+      Box mBox;
+      uint32_t mIndex;
+      uint32_t mCount;
+    };
+
+  private:
+    struct Capsule {
+      double mA[3];
+      double mB[3];
+      double mRadiusA;
+      double mRadiusB;
+      bool mValid;
+    };
+
+    LTCBeamBVH() {}
+
+    //! Distance along a unit direction to where the ray enters beam, or infinity.
+    double rayHit(uint32_t beam, const double origin[3], const double direction[3])const;
+
+    std::vector<Capsule> mCapsules;    //one per beam, indexed like getBeams()
+    std::vector<uint32_t> mPrimitives; //beam indices, in leaf order
+    std::vector<TreeNode> mTree;       //mTree[0] is the root
+  };
+
+}//namespace LTC
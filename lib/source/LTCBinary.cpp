@@ -0,0 +1,439 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCBinary.h"
+#include "LTCFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace LTC {
+
+  static_assert(sizeof(Node) == 10 * sizeof(double) && std::is_standard_layout<Node>::value,
+                "Node must be 10 packed doubles to be read in place");
+  static_assert(sizeof(Beam) == 2 * sizeof(int32_t), "Beam must be 2 packed int32");
+  static_assert(sizeof(Face) == 4 * sizeof(int32_t), "Face must be 4 packed int32");
+
+  namespace {
+    const size_t kSwapChunk = 4096; //records per staging chunk (byte swap, SoA nodes)
+
+    void putU32(unsigned char* p, uint32_t v) {
+      for ( int i = 0; i < 4; i++ ) {
+        p[i] = static_cast<unsigned char>(v >> (8 * i));
+      }
+    }
+
+    void putU64(unsigned char* p, uint64_t v) {
+      for ( int i = 0; i < 8; i++ ) {
+        p[i] = static_cast<unsigned char>(v >> (8 * i));
+      }
+    }
+
+    uint32_t getU32(const unsigned char* p) {
+      uint32_t v = 0;
+      for ( int i = 3; i >= 0; i-- ) {
+        v = (v << 8) | p[i];
+      }
+      return v;
+    }
+
+    uint64_t getU64(const unsigned char* p) {
+      uint64_t v = 0;
+      for ( int i = 7; i >= 0; i-- ) {
+        v = (v << 8) | p[i];
+      }
+      return v;
+    }
+
+    uint64_t alignUp(uint64_t offset) {
+      return (offset + kBinaryAlignment - 1) / kBinaryAlignment * kBinaryAlignment;
+    }
+
+    //Reverses each wordSize word in place (big-endian hosts only)
+    void swapWords(void* data, size_t numOfWords, size_t wordSize) {
+      auto bytes = static_cast<unsigned char*>(data);
+      for ( size_t i = 0; i < numOfWords; i++ ) {
+        std::reverse(bytes + i * wordSize, bytes + (i + 1) * wordSize);
+      }
+    }
+
+    bool writeArray(FILE* file, const void* data, size_t count,
+                    size_t recordSize, size_t wordSize) {
+      if ( count == 0 ) {
+        return true;
+      }
+      if ( isLittleEndian() ) {
+        return fwrite(data, recordSize, count, file) == count;
+      }
+      std::vector<unsigned char> chunk;
+      auto bytes = static_cast<const unsigned char*>(data);
+      for ( size_t first = 0; first < count; first += kSwapChunk ) {
+        size_t n = std::min(kSwapChunk, count - first);
+        chunk.assign(bytes + first * recordSize, bytes + (first + n) * recordSize);
+        swapWords(chunk.data(), n * recordSize / wordSize, wordSize);
+        if ( fwrite(chunk.data(), recordSize, n, file) != n ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool readArray(FILE* file, uint64_t offset, void* data, size_t count,
+                   size_t recordSize, size_t wordSize) {
+      if ( count == 0 ) {
+        return true;
+      }
+      if ( !seekFile(file, offset) || fread(data, recordSize, count, file) != count ) {
+        return false;
+      }
+      if ( !isLittleEndian() ) {
+        swapWords(data, count * recordSize / wordSize, wordSize);
+      }
+      return true;
+    }
+
+    bool writePadding(FILE* file, uint64_t& pos, uint64_t target) {
+      static const unsigned char zeros[kBinaryAlignment] = {};
+      size_t numOfBytes = static_cast<size_t>(target - pos);
+      pos = target;
+      return numOfBytes == 0 || fwrite(zeros, 1, numOfBytes, file) == numOfBytes;
+    }
+
+    //float32 arrays in LTCNodeFormat order
+    template <typename Arrays>
+    auto floatArrays(Arrays& nodes, bool withOrientation) -> std::vector<decltype(&nodes.mX)> {
+      std::vector<decltype(&nodes.mX)> arrays = {
+        &nodes.mX, &nodes.mY, &nodes.mZ, &nodes.mRadius
+      };
+      if ( withOrientation ) {
+        arrays.insert(arrays.end(), {
+          &nodes.mXS, &nodes.mYS, &nodes.mZS, &nodes.mXE, &nodes.mYE, &nodes.mZE
+        });
+      }
+      return arrays;
+    }
+
+    LTCNodeFormat nodeFormat(const LTCGraph& graph) {
+      if ( graph.getNodePrecision() != LTCNodePrecision::FLOAT32 ) {
+        return LTCNodeFormat::AOS_F64;
+      }
+      return graph.getNodeArraysF().hasOrientation() ? LTCNodeFormat::SOA_F32_ORIENTED
+                                                     : LTCNodeFormat::SOA_F32;
+    }
+
+    //SoA float64 graphs are interleaved chunk by chunk into AOS_F64
+    bool writeNodes(FILE* file, const LTCGraph& graph) {
+      if ( graph.getNodePrecision() == LTCNodePrecision::FLOAT32 ) {
+        auto& nodes = graph.getNodeArraysF();
+        for ( auto array : floatArrays(nodes, nodes.hasOrientation()) ) {
+          if ( !writeArray(file, array->data(), array->size(), sizeof(float), sizeof(float)) ) {
+            return false;
+          }
+        }
+        return true;
+      }
+      if ( graph.getNodeStorage() == LTCNodeStorage::AOS ) {
+        const auto& nodes = graph.getNodes();
+        return writeArray(file, nodes.data(), nodes.size(), sizeof(Node), sizeof(double));
+      }
+      std::vector<Node> chunk;
+      size_t count = graph.getNodeCount();
+      for ( size_t first = 0; first < count; first += kSwapChunk ) {
+        size_t n = std::min(kSwapChunk, count - first);
+        chunk.resize(n);
+        for ( size_t i = 0; i < n; i++ ) {
+          chunk[i] = graph.getNode(first + i);
+        }
+        if ( !writeArray(file, chunk.data(), n, sizeof(Node), sizeof(double)) ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool fitsInFile(uint64_t offset, uint64_t count, uint64_t recordSize,
+                    uint64_t fileSize) {
+      return offset <= fileSize && count <= (fileSize - offset) / recordSize;
+    }
+  }
+
+  LTC_ERROR LTCBinary::write(const char* path, const std::vector<LTCGraphP>& graphs) {
+    //Lay the file out first, counts are known so everything is written in one pass
+    std::vector<LTCBinaryGraphEntry> entries(graphs.size());
+    uint64_t pos = kBinaryHeaderSize + uint64_t(kBinaryEntrySize) * graphs.size();
+    for ( size_t i = 0; i < graphs.size(); i++ ) {
+      auto& graph = *graphs[i];
+      auto& entry = entries[i];
+      entry.mID = graph.getID();
+      entry.mUnits = graph.getUnits();
+      entry.mType = graph.isOriented() ? LTCModel::RIB : LTCModel::ROUND;
+      entry.mNodeFormat = nodeFormat(graph);
+
+      entry.mNameOffset = pos;
+      entry.mNameLength = graph.getName().size();
+      pos += entry.mNameLength;
+
+      entry.mNodeOffset = pos = alignUp(pos);
+      entry.mNodeCount = graph.getNodeCount();
+      pos += entry.mNodeCount * nodeSize(entry.mNodeFormat);
+
+      entry.mBeamOffset = pos = alignUp(pos);
+      entry.mBeamCount = graph.getBeams().size();
+      pos += entry.mBeamCount * sizeof(Beam);
+
+      entry.mFaceOffset = pos = alignUp(pos);
+      entry.mFaceCount = graph.getFaces().size();
+      pos += entry.mFaceCount * sizeof(Face);
+    }
+
+    auto file = openFile(path, "wb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+
+    std::vector<unsigned char> toc(kBinaryHeaderSize + kBinaryEntrySize * entries.size(), 0);
+    memcpy(&toc[0], kBinaryMagic, 4);
+    putU32(&toc[4], kBinaryVersion);
+    putU32(&toc[8], static_cast<uint32_t>(entries.size()));
+    putU32(&toc[12], kBinaryEntrySize);
+    putU64(&toc[16], kBinaryHeaderSize);
+    for ( size_t i = 0; i < entries.size(); i++ ) {
+      auto p = &toc[kBinaryHeaderSize + kBinaryEntrySize * i];
+      auto& entry = entries[i];
+      putU32(p + 0, static_cast<uint32_t>(entry.mID));
+      putU32(p + 4, static_cast<uint32_t>(entry.mUnits));
+      putU32(p + 8, entry.mType);
+      putU32(p + 12, static_cast<uint32_t>(entry.mNodeFormat));
+      putU64(p + 16, entry.mNameOffset);
+      putU64(p + 24, entry.mNameLength);
+      putU64(p + 32, entry.mNodeOffset);
+      putU64(p + 40, entry.mNodeCount);
+      putU64(p + 48, entry.mBeamOffset);
+      putU64(p + 56, entry.mBeamCount);
+      putU64(p + 64, entry.mFaceOffset);
+      putU64(p + 72, entry.mFaceCount);
+    }
+
+    bool ok = fwrite(toc.data(), 1, toc.size(), file) == toc.size();
+    pos = toc.size();
+    for ( size_t i = 0; ok && i < graphs.size(); i++ ) {
+      auto& graph = *graphs[i];
+      auto& entry = entries[i];
+      auto& name = graph.getName();
+      ok = fwrite(name.data(), 1, name.size(), file) == name.size();
+      pos += name.size();
+
+      ok = ok && writePadding(file, pos, entry.mNodeOffset) && writeNodes(file, graph);
+      pos += entry.mNodeCount * nodeSize(entry.mNodeFormat);
+
+      const auto& beams = graph.getBeams();
+      ok = ok && writePadding(file, pos, entry.mBeamOffset) &&
+        writeArray(file, beams.data(), beams.size(), sizeof(Beam), sizeof(int32_t));
+      pos += entry.mBeamCount * sizeof(Beam);
+
+      const auto& faces = graph.getFaces();
+      ok = ok && writePadding(file, pos, entry.mFaceOffset) &&
+        writeArray(file, faces.data(), faces.size(), sizeof(Face), sizeof(int32_t));
+      pos += entry.mFaceCount * sizeof(Face);
+    }
+
+    if ( fclose(file) != 0 ) {
+      ok = false;
+    }
+    return ok ? LTC_ERROR::OK : LTC_ERROR::LTC_FILE_WRITE_ERROR;
+  }
+
+  uint64_t LTCBinary::nodeSize(LTCNodeFormat format) {
+    switch ( format ) {
+    case LTCNodeFormat::AOS_F64: return sizeof(Node);
+    case LTCNodeFormat::SOA_F32: return 4 * sizeof(float);
+    case LTCNodeFormat::SOA_F32_ORIENTED: return 10 * sizeof(float);
+    }
+    return sizeof(Node);
+  }
+
+  LTC_ERROR LTCBinary::decodeHeader(const unsigned char* data, uint64_t size,
+                                    LTCBinaryHeader& header) {
+    if ( size < kBinaryHeaderSize || memcmp(data, kBinaryMagic, 4) != 0 ) {
+      return LTC_ERROR::LTC_INVALID_BINARY;
+    }
+    header.mVersion = getU32(data + 4);
+    header.mGraphCount = getU32(data + 8);
+    uint32_t entrySize = getU32(data + 12);
+    header.mTocOffset = getU64(data + 16);
+    if ( header.mVersion > kBinaryVersion ) {
+      return LTC_ERROR::LTC_UNSUPPORTED_VERSION;
+    }
+    if ( entrySize != kBinaryEntrySize ||
+        !fitsInFile(header.mTocOffset, header.mGraphCount, kBinaryEntrySize, size) ) {
+      return LTC_ERROR::LTC_INVALID_BINARY;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCBinary::decodeEntry(const unsigned char* p, uint64_t fileSize,
+                                   LTCBinaryGraphEntry& entry) {
+    entry.mID = static_cast<int32_t>(getU32(p + 0));
+    uint32_t units = getU32(p + 4);
+    entry.mType = getU32(p + 8);
+    uint32_t nodeFormat = getU32(p + 12);
+    entry.mNameOffset = getU64(p + 16);
+    entry.mNameLength = getU64(p + 24);
+    entry.mNodeOffset = getU64(p + 32);
+    entry.mNodeCount = getU64(p + 40);
+    entry.mBeamOffset = getU64(p + 48);
+    entry.mBeamCount = getU64(p + 56);
+    entry.mFaceOffset = getU64(p + 64);
+    entry.mFaceCount = getU64(p + 72);
+
+    if ( units > static_cast<uint32_t>(LTCUnits::FT) ||
+        nodeFormat > static_cast<uint32_t>(LTCNodeFormat::SOA_F32_ORIENTED) ) {
+      return LTC_ERROR::LTC_INVALID_BINARY;
+    }
+    entry.mUnits = static_cast<LTCUnits>(units);
+    entry.mNodeFormat = static_cast<LTCNodeFormat>(nodeFormat);
+
+    if ( !fitsInFile(entry.mNameOffset, entry.mNameLength, 1, fileSize) ||
+        !fitsInFile(entry.mNodeOffset, entry.mNodeCount, nodeSize(entry.mNodeFormat), fileSize) ||
+        !fitsInFile(entry.mBeamOffset, entry.mBeamCount, sizeof(Beam), fileSize) ||
+        !fitsInFile(entry.mFaceOffset, entry.mFaceCount, sizeof(Face), fileSize) ) {
+      return LTC_ERROR::LTC_INVALID_BINARY;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCBinary::readTableOfContents(FILE* file,
+                                           LTCBinaryHeader& header,
+                                           std::vector<LTCBinaryGraphEntry>& entries) {
+    uint64_t fileSize;
+    if ( !getFileSize(file, fileSize) ) {
+      return LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+    }
+    unsigned char head[kBinaryHeaderSize];
+    if ( !seekFile(file, 0) || fread(head, 1, kBinaryHeaderSize, file) != kBinaryHeaderSize ) {
+      return LTC_ERROR::LTC_INVALID_BINARY;
+    }
+    auto err = decodeHeader(head, fileSize, header);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+
+    std::vector<unsigned char> toc(size_t(kBinaryEntrySize) * header.mGraphCount);
+    if ( !toc.empty() &&
+        (!seekFile(file, header.mTocOffset) || fread(toc.data(), 1, toc.size(), file) != toc.size()) ) {
+      return LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+    }
+    entries.resize(header.mGraphCount);
+    for ( size_t i = 0; i < entries.size(); i++ ) {
+      err = decodeEntry(&toc[kBinaryEntrySize * i], fileSize, entries[i]);
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCBinary::readName(FILE* file,
+                                const LTCBinaryGraphEntry& entry,
+                                std::string& name) {
+    name.assign(static_cast<size_t>(entry.mNameLength), '\0');
+    if ( !name.empty() &&
+        (!seekFile(file, entry.mNameOffset) || fread(&name[0], 1, name.size(), file) != name.size()) ) {
+      return LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCBinary::readGraph(FILE* file,
+                                 const LTCBinaryGraphEntry& entry,
+                                 LTCGraphP& graph) {
+    std::string name;
+    auto err = readName(file, entry, name);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+
+    auto count = static_cast<size_t>(entry.mNodeCount);
+    std::vector<Node> nodes;
+    NodeArraysF nodesF;
+    bool ok = true;
+    if ( entry.mNodeFormat == LTCNodeFormat::AOS_F64 ) {
+      nodes.resize(count);
+      ok = readArray(file, entry.mNodeOffset, nodes.data(), count, sizeof(Node), sizeof(double));
+    }
+    else {
+      uint64_t offset = entry.mNodeOffset;
+      bool withOrientation = entry.mNodeFormat == LTCNodeFormat::SOA_F32_ORIENTED;
+      for ( auto array : floatArrays(nodesF, withOrientation) ) {
+        array->resize(count);
+        ok = ok && readArray(file, offset, array->data(), count, sizeof(float), sizeof(float));
+        offset += count * sizeof(float);
+      }
+    }
+    std::vector<Beam> beams(static_cast<size_t>(entry.mBeamCount));
+    std::vector<Face> faces(static_cast<size_t>(entry.mFaceCount));
+    if ( !ok ||
+        !readArray(file, entry.mBeamOffset, beams.data(), beams.size(), sizeof(Beam), sizeof(int32_t)) ||
+        !readArray(file, entry.mFaceOffset, faces.data(), faces.size(), sizeof(Face), sizeof(int32_t)) ) {
+      return LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+    }
+
+    graph = LTCGraph::create(name, entry.mID, entry.mUnits);
+    if ( entry.mNodeFormat == LTCNodeFormat::AOS_F64 ) {
+      graph->setNodes(std::move(nodes));
+    }
+    else {
+      graph->setNodeArrays(std::move(nodesF));
+    }
+    graph->setBeams(std::move(beams));
+    graph->setFaces(std::move(faces));
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCBinary::read(const char* path, std::vector<LTCGraphP>& graphs) {
+    auto file = openFile(path, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+
+    LTCBinaryHeader header;
+    std::vector<LTCBinaryGraphEntry> entries;
+    auto err = readTableOfContents(file, header, entries);
+    for ( size_t i = 0; err == LTC_ERROR::OK && i < entries.size(); i++ ) {
+      LTCGraphP graph;
+      err = readGraph(file, entries[i], graph);
+      if ( err == LTC_ERROR::OK ) {
+        graphs.push_back(graph);
+      }
+    }
+    fclose(file);
+    return err;
+  }
+
+}//namespace LTC
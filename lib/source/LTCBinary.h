@@ -0,0 +1,154 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCModel.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! Binary lattice (.ltcb) layout
+  /*!
+  All values are little-endian.
+
+    header   LTCBinaryHeader, kBinaryHeaderSize bytes
+    toc      header.mGraphCount x LTCBinaryGraphEntry, kBinaryEntrySize bytes each
+    data     graph names & node/beam/face arrays, each array starts on a
+             kBinaryAlignment boundary so it can be mapped in place.
+
+  Header, 32 bytes at offset 0:
+     0  char[4]  magic "LTCB"
+     4  uint32   version, kBinaryVersion
+     8  uint32   graph count
+    12  uint32   toc entry size, kBinaryEntrySize
+    16  uint64   toc offset, kBinaryHeaderSize
+    24  8 bytes  reserved, zero
+
+  Toc entry, 96 bytes per graph, offsets are absolute from file start:
+     0  int32    graph id
+     4  uint32   units, LTCUnits
+     8  uint32   type, LTCModel::GRAPH_TYPE
+    12  uint32   node format, LTCNodeFormat
+    16  uint64   name offset
+    24  uint64   name length in bytes, UTF-8 without a terminator
+    32  uint64   node offset
+    40  uint64   node count
+    48  uint64   beam offset
+    56  uint64   beam count
+    64  uint64   face offset
+    72  uint64   face count
+    80  16 bytes reserved, zero
+
+  Gaps before an aligned array are zero filled. Arrays hold exactly the
+  in-memory records, positions & radii in mm whatever the units field says:
+    node  10 x float64: x y z xs ys zs xe ye ze r   (LTC::Node)
+    beam   2 x int32:   n1 n2                       (LTC::Beam)
+    face   4 x int32:   n1 n2 n3 n4, n4 = -1 for triangles (LTC::Face)
+
+  Graphs stored in LTCNodePrecision::FLOAT32 keep their nodes as back to
+  back float32 arrays instead (LTC::NodeArraysF), see LTCNodeFormat.
+  */
+  static const char kBinaryMagic[4] = { 'L', 'T', 'C', 'B' };
+  static const uint32_t kBinaryVersion = 1;
+  static const uint32_t kBinaryHeaderSize = 32;
+  static const uint32_t kBinaryEntrySize = 96;
+  static const uint32_t kBinaryAlignment = 64;
+
+  //! LTCNodeFormat
+  /*!
+  Layout of a graph's node block.
+  AOS_F64            nodeCount x LTC::Node
+  SOA_F32            float32 arrays x, y, z, r; nodeCount values each
+  SOA_F32_ORIENTED   as SOA_F32, followed by xs, ys, zs, xe, ye, ze
+  */
+  enum class LTCNodeFormat {
+    AOS_F64 = 0,
+    SOA_F32 = 1,
+    SOA_F32_ORIENTED = 2,
+  };
+
+  //! LTCBinaryHeader
+  struct LTCBinaryHeader {
+    uint32_t mVersion;
+    uint32_t mGraphCount;
+    uint64_t mTocOffset;
+  };
+
+  //! LTCBinaryGraphEntry
+  /*!
+  Table of contents entry, offsets are absolute from the start of the file.
+  */
+  struct LTCBinaryGraphEntry {
+    int32_t mID;
+    LTCUnits mUnits;
+    uint32_t mType; //LTCModel::GRAPH_TYPE
+    LTCNodeFormat mNodeFormat;
+    uint64_t mNameOffset, mNameLength;
+    uint64_t mNodeOffset, mNodeCount;
+    uint64_t mBeamOffset, mBeamCount;
+    uint64_t mFaceOffset, mFaceCount;
+  };
+
+  //! LTCBinary
+  /*!
+  Reads & writes the binary lattice format. On little-endian hosts arrays
+  are transferred straight between the file & the graph's vectors.
+  */
+  class LTCBinary {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    static LTC_ERROR write(const char* path, const std::vector<LTCGraphP>& graphs);
+    static LTC_ERROR read(const char* path, std::vector<LTCGraphP>& graphs);
+
+    static LTC_ERROR readTableOfContents(FILE* file,
+                                         LTCBinaryHeader& header,
+                                         std::vector<LTCBinaryGraphEntry>& entries);
+    static LTC_ERROR readGraph(FILE* file,
+                               const LTCBinaryGraphEntry& entry,
+                               LTCGraphP& graph);
+    //! Just the name, e.g. to pick a graph from the table of contents.
+    static LTC_ERROR readName(FILE* file,
+                              const LTCBinaryGraphEntry& entry,
+                              std::string& name);
+
+    //! Bytes per node in the given format.
+    static uint64_t nodeSize(LTCNodeFormat format);
+
+    //! Decoders for callers that already have the bytes, e.g. a mapped file.
+    static LTC_ERROR decodeHeader(const unsigned char* data, uint64_t size,
+                                  LTCBinaryHeader& header);
+    static LTC_ERROR decodeEntry(const unsigned char* data, uint64_t fileSize,
+                                 LTCBinaryGraphEntry& entry);
+  };
+
+}//namespace LTC
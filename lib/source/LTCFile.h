@@ -0,0 +1,119 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace LTC {
+
+  //! openFile
+  /*!
+  fopen wrapper, MSVC's SDL checks reject plain fopen.
+  */
+  inline FILE* openFile(const char* path, const char* mode) {
+#if defined(_MSC_VER)
+    FILE* file = nullptr;
+    if ( fopen_s(&file, path, mode) != 0 ) {
+      return nullptr;
+    }
+    return file;
+#else
+    return fopen(path, mode);
+#endif
+  }
+
+  //! seekFile
+  /*!
+  64-bit safe fseek(SEEK_SET), lattice files easily exceed 2 GB.
+  */
+  inline bool seekFile(FILE* file, uint64_t offset) {
+#if defined(_MSC_VER)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+  }
+
+  //! getFileSize
+  /*!
+  Size of an open file in bytes, the file position is restored.
+  */
+  inline bool getFileSize(FILE* file, uint64_t& size) {
+#if defined(_MSC_VER)
+    __int64 pos = _ftelli64(file);
+    if ( pos < 0 || _fseeki64(file, 0, SEEK_END) != 0 ) {
+      return false;
+    }
+    __int64 end = _ftelli64(file);
+    _fseeki64(file, pos, SEEK_SET);
+#else
+    off_t pos = ftello(file);
+    if ( pos < 0 || fseeko(file, 0, SEEK_END) != 0 ) {
+      return false;
+    }
+    off_t end = ftello(file);
+    fseeko(file, pos, SEEK_SET);
+#endif
+    if ( end < 0 ) {
+      return false;
+    }
+    size = static_cast<uint64_t>(end);
+    return true;
+  }
+
+  //! getFileTime
+  /*!
+  Last modification time of the file at path, in seconds since the epoch.
+  */
+  inline bool getFileTime(const char* path, uint64_t& time) {
+#if defined(_MSC_VER)
+    struct _stat64 info;
+    if ( _stat64(path, &info) != 0 ) {
+      return false;
+    }
+#else
+    struct stat info;
+    if ( stat(path, &info) != 0 ) {
+      return false;
+    }
+#endif
+    time = static_cast<uint64_t>(info.st_mtime);
+    return true;
+  }
+
+  inline bool isLittleEndian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+  }
+
+}//namespace LTC
@@ -25,8 +25,498 @@
 //
 
 #include "LTCGraph.h"
+#include "LTCAdjacency.h"
+#include "LTCNodeGrid.h"
+#include "LTCNodeOrder.h"
+#include "LTCParallel.h"
+#include "LTCSimd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 
 namespace LTC {
+  template <typename T>
+  void NodeArraysT<T>::reserve(size_t count, bool withOrientation /*= false*/) {
+    mX.reserve(count);
+    mY.reserve(count);
+    mZ.reserve(count);
+    mRadius.reserve(count);
+    if ( withOrientation || hasOrientation() ) {
+      mXS.reserve(count);
+      mYS.reserve(count);
+      mZS.reserve(count);
+      mXE.reserve(count);
+      mYE.reserve(count);
+      mZE.reserve(count);
+    }
+  }
+
+  template <typename T>
+  void NodeArraysT<T>::push_back(const Node& node) {
+    bool withOrientation = hasOrientation();
+    if ( !withOrientation &&
+        (node.mXS != -1.0 || node.mYS != -1.0 || node.mZS != -1.0 ||
+         node.mXE != -1.0 || node.mYE != -1.0 || node.mZE != -1.0) ) {
+      //first node with orientation, earlier nodes get the Node() defaults
+      withOrientation = true;
+      mXS.assign(size(), T(-1));
+      mYS.assign(size(), T(-1));
+      mZS.assign(size(), T(-1));
+      mXE.assign(size(), T(-1));
+      mYE.assign(size(), T(-1));
+      mZE.assign(size(), T(-1));
+    }
+    mX.push_back(static_cast<T>(node.mX));
+    mY.push_back(static_cast<T>(node.mY));
+    mZ.push_back(static_cast<T>(node.mZ));
+    mRadius.push_back(static_cast<T>(node.mRadius));
+    if ( withOrientation ) {
+      mXS.push_back(static_cast<T>(node.mXS));
+      mYS.push_back(static_cast<T>(node.mYS));
+      mZS.push_back(static_cast<T>(node.mZS));
+      mXE.push_back(static_cast<T>(node.mXE));
+      mYE.push_back(static_cast<T>(node.mYE));
+      mZE.push_back(static_cast<T>(node.mZE));
+    }
+  }
+
+  template <typename T>
+  void NodeArraysT<T>::append(const NodeArraysT& other) {
+    size_t count = size();
+    size_t otherCount = other.size();
+    bool withOrientation = hasOrientation() || other.hasOrientation();
+    reserve(count + otherCount, withOrientation);
+    mX.insert(mX.end(), other.mX.begin(), other.mX.end());
+    mY.insert(mY.end(), other.mY.begin(), other.mY.end());
+    mZ.insert(mZ.end(), other.mZ.begin(), other.mZ.end());
+    mRadius.insert(mRadius.end(), other.mRadius.begin(), other.mRadius.end());
+    if ( !withOrientation ) {
+      return;
+    }
+    std::vector<T>* fields[] = { &mXS, &mYS, &mZS, &mXE, &mYE, &mZE };
+    const std::vector<T>* otherFields[] = { &other.mXS, &other.mYS, &other.mZS,
+                                            &other.mXE, &other.mYE, &other.mZE };
+    for ( int f = 0; f < 6; f++ ) {
+      fields[f]->resize(count, T(-1));
+      if ( other.hasOrientation() ) {
+        fields[f]->insert(fields[f]->end(), otherFields[f]->begin(), otherFields[f]->end());
+      }
+      else {
+        fields[f]->resize(count + otherCount, T(-1));
+      }
+    }
+  }
+
+  template <typename T>
+  Node NodeArraysT<T>::get(size_t idx)const {
+    Node node;
+    node.mX = mX[idx];
+    node.mY = mY[idx];
+    node.mZ = mZ[idx];
+    node.mRadius = mRadius[idx];
+    if ( hasOrientation() ) {
+      node.mXS = mXS[idx];
+      node.mYS = mYS[idx];
+      node.mZS = mZS[idx];
+      node.mXE = mXE[idx];
+      node.mYE = mYE[idx];
+      node.mZE = mZE[idx];
+    }
+    return node;
+  }
+
+  template <typename T>
+  void NodeArraysT<T>::clear() {
+    *this = NodeArraysT<T>();
+  }
+
+  template struct NodeArraysT<double>;
+  template struct NodeArraysT<float>;
+
+  const std::vector<Node>& LTCGraph::getNodes()const {
+    if ( mNodeStorage == LTCNodeStorage::SOA && !mNodeCacheValid ) {
+      size_t count = getNodeCount();
+      mNodes.clear();
+      mNodes.reserve(count);
+      for ( size_t i = 0; i < count; i++ ) {
+        mNodes.push_back(getNode(i));
+      }
+      mNodeCacheValid = true;
+    }
+    return mNodes;
+  }
+
+  void LTCGraph::setNodes(const std::vector<Node>& nodes) {
+    if ( mNodeStorage == LTCNodeStorage::SOA ) {
+      invalidateNodeCache();
+      mNodeArrays.clear();
+      mNodeArraysF.clear();
+      if ( mNodePrecision == LTCNodePrecision::FLOAT32 ) {
+        mNodeArraysF.reserve(nodes.size());
+      }
+      else {
+        mNodeArrays.reserve(nodes.size());
+      }
+      for ( auto& n : nodes ) {
+        pushNode(n);
+      }
+    }
+    else {
+      mNodes = nodes;
+    }
+  }
+
+  void LTCGraph::setNodes(std::vector<Node>&& nodes) {
+    if ( mNodeStorage == LTCNodeStorage::SOA ) {
+      setNodes(static_cast<const std::vector<Node>&>(nodes));
+      nodes = std::vector<Node>();
+    }
+    else {
+      mNodes = std::move(nodes);
+    }
+  }
+
+  std::vector<Node> LTCGraph::takeNodes() {
+    getNodes();
+    std::vector<Node> nodes;
+    nodes.swap(mNodes);
+    mNodeCacheValid = false;
+    mNodeArrays.clear();
+    mNodeArraysF.clear();
+    return nodes;
+  }
+
+  void LTCGraph::setNodeStorage(LTCNodeStorage storage) {
+    if ( storage == mNodeStorage ) {
+      return;
+    }
+    auto nodes = takeNodes();
+    mNodeStorage = storage;
+    if ( storage == LTCNodeStorage::AOS ) {
+      mNodePrecision = LTCNodePrecision::FLOAT64;
+    }
+    setNodes(std::move(nodes));
+  }
+
+  void LTCGraph::setNodePrecision(LTCNodePrecision precision) {
+    if ( precision == mNodePrecision ) {
+      return;
+    }
+    auto nodes = takeNodes();
+    mNodePrecision = precision;
+    if ( precision == LTCNodePrecision::FLOAT32 ) {
+      mNodeStorage = LTCNodeStorage::SOA;
+    }
+    setNodes(std::move(nodes));
+  }
+
+  size_t LTCGraph::getNodeCount()const {
+    if ( mNodeStorage == LTCNodeStorage::AOS ) {
+      return mNodes.size();
+    }
+    return mNodePrecision == LTCNodePrecision::FLOAT32 ? mNodeArraysF.size()
+                                                       : mNodeArrays.size();
+  }
+
+  Node LTCGraph::getNode(size_t idx)const {
+    if ( mNodeStorage == LTCNodeStorage::AOS ) {
+      return mNodes[idx];
+    }
+    return mNodePrecision == LTCNodePrecision::FLOAT32 ? mNodeArraysF.get(idx)
+                                                       : mNodeArrays.get(idx);
+  }
+
+  bool LTCGraph::isOriented()const {
+    if ( mNodeStorage == LTCNodeStorage::SOA &&
+        !mNodeArrays.hasOrientation() && !mNodeArraysF.hasOrientation() ) {
+      return false;
+    }
+    size_t count = getNodeCount();
+    for ( size_t i = 0; i < count; i++ ) {
+      Node n = getNode(i);
+      if ( n.mXS != n.mXE ||
+          n.mYS != n.mYE ||
+          n.mZS != n.mZE ) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void LTCGraph::setNodeArrays(NodeArrays&& arrays) {
+    mNodes = std::vector<Node>();
+    mNodeCacheValid = false;
+    mNodeArrays.clear();
+    mNodeArraysF.clear();
+    mNodeStorage = LTCNodeStorage::SOA;
+    mNodePrecision = LTCNodePrecision::FLOAT64;
+    mNodeArrays = std::move(arrays);
+  }
+
+  void LTCGraph::setNodeArrays(NodeArraysF&& arrays) {
+    mNodes = std::vector<Node>();
+    mNodeCacheValid = false;
+    mNodeArrays.clear();
+    mNodeArraysF.clear();
+    mNodeStorage = LTCNodeStorage::SOA;
+    mNodePrecision = LTCNodePrecision::FLOAT32;
+    mNodeArraysF = std::move(arrays);
+  }
+
+  void LTCGraph::pushNode(const Node& node) {
+    if ( mNodeStorage == LTCNodeStorage::AOS ) {
+      mNodes.push_back(node);
+      return;
+    }
+    invalidateNodeCache();
+    if ( mNodePrecision == LTCNodePrecision::FLOAT32 ) {
+      mNodeArraysF.push_back(node);
+    }
+    else {
+      mNodeArrays.push_back(node);
+    }
+  }
+
+  namespace {
+    template <typename T>
+    NodeArraysT<T> gatherArrays(const NodeArraysT<T>& arrays, const std::vector<int>& order) {
+      NodeArraysT<T> gathered;
+      gathered.reserve(order.size(), arrays.hasOrientation());
+      for ( int idx : order ) {
+        gathered.push_back(arrays.get(idx));
+      }
+      return gathered;
+    }
+
+    const size_t kBlockSize = 1 << 14;
+  }
+
+  void LTCGraph::gatherNodes(const std::vector<int>& order) {
+    if ( mNodeStorage == LTCNodeStorage::AOS ) {
+      std::vector<Node> nodes;
+      nodes.reserve(order.size());
+      for ( int idx : order ) {
+        nodes.push_back(mNodes[idx]);
+      }
+      mNodes.swap(nodes);
+      return;
+    }
+    invalidateNodeCache();
+    if ( mNodePrecision == LTCNodePrecision::FLOAT32 ) {
+      mNodeArraysF = gatherArrays(mNodeArraysF, order);
+    }
+    else {
+      mNodeArrays = gatherArrays(mNodeArrays, order);
+    }
+  }
+
+  LTCWeldStats LTCGraph::weld(double tolerance, unsigned int numOfThreads,
+                              std::vector<int>* nodeMap) {
+    LTCWeldStats stats;
+    numOfThreads = resolveThreadCount(numOfThreads);
+    tolerance = std::max(tolerance, 0.0);
+    size_t numOfNodes = getNodeCount();
+
+    //nodes within tolerance of each other are joined with a union-find,
+    //every group's root is its lowest node
+    std::vector<int> map(numOfNodes);
+    for ( size_t i = 0; i < numOfNodes; i++ ) {
+      map[i] = static_cast<int>(i);
+    }
+    if ( numOfNodes ) {
+      //cells twice the tolerance keep a lookup to 8 of them
+      auto grid = LTCNodeGrid::create(*this, tolerance > 0.0 ? 2.0 * tolerance : 1.0, numOfThreads);
+      size_t numOfBlocks = (numOfNodes + kBlockSize - 1) / kBlockSize;
+      //pairs (lower, higher) of nodes within tolerance, by block
+      std::vector<std::vector<std::pair<int, int>>> pairs(numOfBlocks);
+      parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+        size_t end = std::min((block + 1) * kBlockSize, numOfNodes);
+        std::vector<int> found;
+        for ( size_t i = block * kBlockSize; i < end; i++ ) {
+          Node node = getNode(i);
+          double point[3] = { node.mX, node.mY, node.mZ };
+          //NaN positions find nothing, not even themselves
+          grid->findWithin(point, tolerance, found);
+          for ( int other : found ) {
+            if ( other >= static_cast<int>(i) ) {
+              break; //ascending
+            }
+            pairs[block].push_back(std::make_pair(other, static_cast<int>(i)));
+          }
+        }
+      });
+      auto findRoot = [&](int node) {
+        while ( map[node] != node ) {
+          map[node] = map[map[node]];
+          node = map[node];
+        }
+        return node;
+      };
+      for ( auto& blockPairs : pairs ) {
+        for ( auto& pair : blockPairs ) {
+          int a = findRoot(pair.first);
+          int b = findRoot(pair.second);
+          if ( a != b ) {
+            map[std::max(a, b)] = std::min(a, b);
+          }
+        }
+      }
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        map[i] = findRoot(static_cast<int>(i));
+      }
+    }
+    std::vector<int> order;
+    for ( size_t i = 0; i < numOfNodes; i++ ) {
+      if ( map[i] == static_cast<int>(i) ) {
+        map[i] = static_cast<int>(order.size());
+        order.push_back(static_cast<int>(i));
+      }
+      else {
+        map[i] = map[map[i]];
+      }
+    }
+    stats.mMergedNodes = numOfNodes - order.size();
+    if ( stats.mMergedNodes ) {
+      gatherNodes(order);
+    }
+    order = std::vector<int>();
+
+    auto remap = [&](int node) {
+      return node >= 0 && static_cast<size_t>(node) < numOfNodes ? map[node] : -1;
+    };
+
+    //beams: remap, then sort by node pair to find the duplicates, the
+    //lowest beam of each pair stays
+    size_t numOfBeams = mBeams.size();
+    std::vector<uint64_t> keys(numOfBeams);
+    size_t numOfBlocks = (numOfBeams + kBlockSize - 1) / kBlockSize;
+    parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+      size_t end = std::min((block + 1) * kBlockSize, numOfBeams);
+      for ( size_t i = block * kBlockSize; i < end; i++ ) {
+        Beam& beam = mBeams[i];
+        beam.mNode1Idx = remap(beam.mNode1Idx);
+        beam.mNode2Idx = remap(beam.mNode2Idx);
+        auto n1 = static_cast<uint32_t>(std::min(beam.mNode1Idx, beam.mNode2Idx));
+        auto n2 = static_cast<uint32_t>(std::max(beam.mNode1Idx, beam.mNode2Idx));
+        bool degenerate = beam.mNode1Idx < 0 || beam.mNode2Idx < 0 || n1 == n2;
+        keys[i] = degenerate ? UINT64_MAX : (static_cast<uint64_t>(n1) << 32 | n2);
+      }
+    });
+    std::vector<uint32_t> sorted(numOfBeams);
+    for ( size_t i = 0; i < numOfBeams; i++ ) {
+      sorted[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+      return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+    });
+    std::vector<bool> keep(numOfBeams, true);
+    for ( size_t i = 0; i < numOfBeams; i++ ) {
+      uint32_t beam = sorted[i];
+      if ( keys[beam] == UINT64_MAX ) {
+        keep[beam] = false;
+        stats.mDegenerateBeams++;
+      }
+      else if ( i > 0 && keys[sorted[i - 1]] == keys[beam] ) {
+        keep[beam] = false;
+        stats.mDuplicateBeams++;
+      }
+    }
+    size_t numOfKept = 0;
+    for ( size_t i = 0; i < numOfBeams; i++ ) {
+      if ( keep[i] ) {
+        mBeams[numOfKept++] = mBeams[i];
+      }
+    }
+    mBeams.resize(numOfKept);
+    mAdjacency = nullptr;
+
+    //faces: drop repeated corners, keep what still spans an area
+    numOfKept = 0;
+    for ( auto& face : mFaces ) {
+      int corners[4] = { face.v0, face.v1, face.v2, face.v3 };
+      int numOfCorners = face.v3 == -1 ? 3 : 4;
+      int distinct[4];
+      int numOfDistinct = 0;
+      bool valid = true;
+      for ( int c = 0; c < numOfCorners; c++ ) {
+        int node = remap(corners[c]);
+        valid = valid && node >= 0;
+        if ( numOfDistinct == 0 || distinct[numOfDistinct - 1] != node ) {
+          distinct[numOfDistinct++] = node;
+        }
+      }
+      if ( numOfDistinct > 1 && distinct[numOfDistinct - 1] == distinct[0] ) {
+        numOfDistinct--;
+      }
+      //a quad folded onto its diagonal (a b a c) has no area either
+      if ( numOfDistinct == 4 && (distinct[0] == distinct[2] || distinct[1] == distinct[3]) ) {
+        numOfDistinct = 0;
+      }
+      if ( !valid || numOfDistinct < 3 ) {
+        stats.mDegenerateFaces++;
+        continue;
+      }
+      Face& out = mFaces[numOfKept++];
+      out.v0 = distinct[0];
+      out.v1 = distinct[1];
+      out.v2 = distinct[2];
+      out.v3 = numOfDistinct == 4 ? distinct[3] : -1;
+    }
+    mFaces.resize(numOfKept);
+
+    if ( nodeMap ) {
+      nodeMap->swap(map);
+    }
+    return stats;
+  }
+
+  void LTCGraph::reorderNodes(LTCNodeOrder order, unsigned int numOfThreads,
+                              std::vector<int>* nodeMap) {
+    numOfThreads = resolveThreadCount(numOfThreads);
+    std::vector<int> nodes;
+    getNodeOrder(*this, order, numOfThreads, nodes);
+    size_t numOfNodes = nodes.size();
+    std::vector<int> map(numOfNodes);
+    for ( size_t i = 0; i < numOfNodes; i++ ) {
+      map[nodes[i]] = static_cast<int>(i);
+    }
+    gatherNodes(nodes);
+
+    auto remap = [&](int& node) {
+      if ( node >= 0 && static_cast<size_t>(node) < numOfNodes ) {
+        node = map[node];
+      }
+    };
+    size_t numOfBeams = mBeams.size();
+    size_t numOfBlocks = (numOfBeams + kBlockSize - 1) / kBlockSize;
+    parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+      size_t end = std::min((block + 1) * kBlockSize, numOfBeams);
+      for ( size_t i = block * kBlockSize; i < end; i++ ) {
+        remap(mBeams[i].mNode1Idx);
+        remap(mBeams[i].mNode2Idx);
+      }
+    });
+    for ( auto& face : mFaces ) {
+      remap(face.v0);
+      remap(face.v1);
+      remap(face.v2);
+      remap(face.v3);
+    }
+    mAdjacency = nullptr;
+
+    if ( nodeMap ) {
+      nodeMap->swap(map);
+    }
+  }
+
+  void LTCGraph::invalidateNodeCache() {
+    if ( mNodeCacheValid ) {
+      mNodes = std::vector<Node>();
+      mNodeCacheValid = false;
+    }
+  }
+
   void LTCGraph::addNode(double x, double y, double z, double radius /*= -1.0*/) {
     auto newNode = Node();
 
@@ -65,7 +555,7 @@ namespace LTC {
     if ( radius == -1.0 ) {
       newNode.mRadius = -1.0;
     }
-    mNodes.push_back(std::move(newNode));
+    pushNode(newNode);
   }
 
   void LTCGraph::addNode(double x, double y, double z, double radius, double xS, double yS, double zS, double xE, double yE, double zE) {
@@ -140,7 +630,136 @@ namespace LTC {
     if ( radius == -1.0 ) {
       newNode.mRadius = -1.0;
     }
-    mNodes.push_back(std::move(newNode));
+    pushNode(newNode);
+  }
+
+  namespace {
+    template <typename T>
+    void appendScaled(std::vector<T>& out, LTCSpan<const double> values, double scale) {
+      size_t first = out.size();
+      out.resize(first + values.size());
+      T* dst = out.data() + first;
+      if ( scale == 1.0 ) {
+        for ( size_t i = 0; i < values.size(); i++ ) {
+          dst[i] = static_cast<T>(values[i]);
+        }
+      }
+      else {
+        for ( size_t i = 0; i < values.size(); i++ ) {
+          dst[i] = static_cast<T>(values[i] * scale);
+        }
+      }
+    }
+
+    template <typename T>
+    void appendNodes(NodeArraysT<T>& nodes,
+                     LTCSpan<const double> x,
+                     LTCSpan<const double> y,
+                     LTCSpan<const double> z,
+                     LTCSpan<const double> radius,
+                     double scale) {
+      size_t count = x.size();
+      size_t total = nodes.size() + count;
+      appendScaled(nodes.mX, x, scale);
+      appendScaled(nodes.mY, y, scale);
+      appendScaled(nodes.mZ, z, scale);
+      if ( radius.empty() ) {
+        nodes.mRadius.resize(total, T(-1));
+      }
+      else {
+        size_t first = nodes.mRadius.size();
+        appendScaled(nodes.mRadius, radius, scale);
+        for ( size_t i = 0; i < count; i++ ) {
+          if ( radius[i] == -1.0 ) {
+            nodes.mRadius[first + i] = T(-1);
+          }
+        }
+      }
+      if ( nodes.hasOrientation() ) {
+        for ( auto array : { &nodes.mXS, &nodes.mYS, &nodes.mZS,
+                            &nodes.mXE, &nodes.mYE, &nodes.mZE } ) {
+          array->resize(total, T(-1));
+        }
+      }
+    }
+  }
+
+  void LTCGraph::addNodes(LTCSpan<const double> x,
+                          LTCSpan<const double> y,
+                          LTCSpan<const double> z,
+                          LTCSpan<const double> radius) {
+    double scale = getUnitScale(mUnits);
+    if ( mNodeStorage == LTCNodeStorage::SOA ) {
+      invalidateNodeCache();
+      if ( mNodePrecision == LTCNodePrecision::FLOAT32 ) {
+        appendNodes(mNodeArraysF, x, y, z, radius, scale);
+      }
+      else {
+        appendNodes(mNodeArrays, x, y, z, radius, scale);
+      }
+      return;
+    }
+
+    size_t first = mNodes.size();
+    mNodes.resize(first + x.size());
+    Node* dst = mNodes.data() + first;
+    for ( size_t i = 0; i < x.size(); i++ ) {
+      dst[i].mX = x[i] * scale;
+      dst[i].mY = y[i] * scale;
+      dst[i].mZ = z[i] * scale;
+      if ( !radius.empty() && radius[i] != -1.0 ) {
+        dst[i].mRadius = radius[i] * scale;
+      }
+    }
+  }
+
+  void LTCGraph::scaleNodes(double factor) {
+    if ( mNodeStorage == LTCNodeStorage::AOS ) {
+      LTC::scaleNodes(mNodes.data(), mNodes.size(), factor);
+    }
+    else {
+      invalidateNodeCache();
+      if ( mNodePrecision == LTCNodePrecision::FLOAT32 ) {
+        LTC::scaleNodes(mNodeArraysF, factor);
+      }
+      else {
+        LTC::scaleNodes(mNodeArrays, factor);
+      }
+    }
+  }
+
+  double LTCGraph::getUnitScale(LTCUnits units) {
+    switch ( units ) {
+    case LTCUnits::MM: return 1.0;
+    case LTCUnits::CM: return 10.0;
+    case LTCUnits::M: return 100.0;
+    case LTCUnits::FT: return 304.8;
+    case LTCUnits::IN: return 25.4;
+    }
+    return 1.0;
+  }
+
+  void LTCGraph::addBeams(LTCSpan<const Beam> beams) {
+    mBeams.insert(mBeams.end(), beams.begin(), beams.end());
+    mAdjacency = nullptr;
+  }
+
+  void LTCGraph::addFaces(LTCSpan<const Face> faces) {
+    mFaces.insert(mFaces.end(), faces.begin(), faces.end());
+  }
+
+  void LTCGraph::reserve(size_t numOfNodes, size_t numOfBeams, size_t numOfFaces) {
+    if ( mNodeStorage == LTCNodeStorage::AOS ) {
+      mNodes.reserve(numOfNodes);
+    }
+    else if ( mNodePrecision == LTCNodePrecision::FLOAT32 ) {
+      mNodeArraysF.reserve(numOfNodes);
+    }
+    else {
+      mNodeArrays.reserve(numOfNodes);
+    }
+    mBeams.reserve(numOfBeams);
+    mFaces.reserve(numOfFaces);
   }
 
   void LTCGraph::addBeam(int idx1, int idx2) {
@@ -149,6 +768,14 @@ namespace LTC {
     newBeam.mNode2Idx = idx2;
 
     mBeams.push_back(std::move(newBeam));
+    mAdjacency = nullptr;
+  }
+
+  std::shared_ptr<const LTCAdjacency> LTCGraph::getAdjacency(unsigned int numOfThreads)const {
+    if ( !mAdjacency || mAdjacency->getNodeCount() != getNodeCount() ) {
+      mAdjacency = LTCAdjacency::create(getNodeCount(), mBeams, numOfThreads);
+    }
+    return mAdjacency;
   }
 
   void LTCGraph::addFace(int n0, int n1, int n2, int n3 /*= -1*/) {
@@ -25,6 +25,8 @@
 //
 
 #pragma once
+#include "LTCSpan.h"
+
 #include <memory>
 #include <vector>
 #include <string>
@@ -59,6 +61,65 @@ namespace LTC {
     double mRadius;
   };
 
+  //! NodeArraysT
+  /*!
+  Structure of arrays layout for nodes, one array per field. The
+  orientation arrays stay empty until a node with orientation data is
+  added, so a round lattice costs 4 values per node instead of 10.
+  Instantiated for double (NodeArrays) & float (NodeArraysF).
+  */
+  template <typename T>
+  struct NodeArraysT {
+    std::vector<T> mX, mY, mZ;
+    std::vector<T> mXS, mYS, mZS;
+    std::vector<T> mXE, mYE, mZE;
+
+    std::vector<T> mRadius;
+
+    size_t size()const { return mX.size(); }
+    bool hasOrientation()const { return !mXS.empty(); }
+
+    void reserve(size_t count, bool withOrientation = false);
+    void push_back(const Node& node);
+    //! Appends all of other's nodes, orientation is filled in with -1 where one side has none.
+    void append(const NodeArraysT& other);
+    Node get(size_t idx)const;
+    void clear();
+  };
+
+  typedef NodeArraysT<double> NodeArrays;
+  typedef NodeArraysT<float> NodeArraysF;
+
+  //! LTCNodeStorage
+  /*!
+  How LTCGraph keeps its nodes, see LTCGraph::setNodeStorage.
+  */
+  enum class LTCNodeStorage {
+    AOS = 0,  //std::vector<Node>
+    SOA = 1   //NodeArrays, or NodeArraysF for LTCNodePrecision::FLOAT32
+  };
+
+  //! LTCNodePrecision
+  /*!
+  Precision node values are stored in. FLOAT32 halves the memory again &
+  is plenty for printer resolution; it always uses the SoA layout. Values
+  are converted to mm in double & rounded to float once.
+  */
+  enum class LTCNodePrecision {
+    FLOAT64 = 0,
+    FLOAT32 = 1
+  };
+
+  //! LTCNodeOrder
+  /*!
+  Orders for LTCGraph::reorderNodes, see LTCNodeOrder.h.
+  */
+  enum class LTCNodeOrder {
+    MORTON = 0,   //Z-order curve over the bounding box
+    HILBERT = 1,  //Hilbert curve over the bounding box, no jumps between neighbouring cells
+    RCM = 2       //reverse Cuthill-McKee on the beams, small index distance across beams
+  };
+
   //! Beam
   /*!
   Represents a beam, additional properties can be added here.
@@ -75,10 +136,34 @@ namespace LTC {
     int v0, v1, v2, v3;
   };
 
+  //! LTCWeldStats
+  /*!
+  What LTCGraph::weld removed.
+  */
+  struct LTCWeldStats {
+    LTCWeldStats() :
+      mMergedNodes(0),
+      mDegenerateBeams(0),
+      mDuplicateBeams(0),
+      mDegenerateFaces(0) {}
+    size_t mMergedNodes;
+    size_t mDegenerateBeams;  //n1 == n2 after merging, or a node out of range
+    size_t mDuplicateBeams;   //same two nodes as an earlier beam, either direction
+    size_t mDegenerateFaces;  //fewer than 3 distinct nodes, or a node out of range
+  };
+
+  class LTCAdjacency;
 
   //! LTCGraph
   /*!
   Represents a Lattice Graph.
+
+  Nodes are stored as std::vector<Node> by default. With
+  setNodeStorage(LTCNodeStorage::SOA) they move into NodeArrays instead;
+  getNodeCount / getNode / getNodeArrays then read them without a copy,
+  while getNodes builds (and caches) an AoS copy on first use. The cache
+  is dropped by any change to the nodes & is not safe to build from
+  several threads at once.
   */
   class LTCGraph {
   public:
@@ -94,11 +179,17 @@ namespace LTC {
   public:
     LTCGraph(int id) :
       mID{ id },
-      mUnits{ LTCUnits::MM } {}
+      mUnits{ LTCUnits::MM },
+      mNodeStorage{ LTCNodeStorage::AOS },
+      mNodePrecision{ LTCNodePrecision::FLOAT64 },
+      mNodeCacheValid{ false } {}
     LTCGraph(const std::string& name, int id, LTCUnits units = LTCUnits::MM) :
       mName{ name },
       mID{ id },
-      mUnits{ units } {}
+      mUnits{ units },
+      mNodeStorage{ LTCNodeStorage::AOS },
+      mNodePrecision{ LTCNodePrecision::FLOAT64 },
+      mNodeCacheValid{ false } {}
 
     void setName(const std::string& name) { mName = name; }
     void setUnits(LTCUnits units) { mUnits = units; }
@@ -111,7 +202,34 @@ namespace LTC {
     void addBeam(int idx1, int idx2);
     void addFace(int n0, int n1, int n2, int n3 = -1);
 
-    const std::vector<Node>& getNodes()const { return mNodes; }
+    //! Appends x.size() nodes in one pass.
+    /*!
+    Same conversion as addNode, but the units are looked at once & the
+    storage grows once. y, z & radius must be as long as x; an empty
+    radius span adds nodes without radius (-1).
+    */
+    void addNodes(LTCSpan<const double> x,
+                  LTCSpan<const double> y,
+                  LTCSpan<const double> z,
+                  LTCSpan<const double> radius = LTCSpan<const double>());
+    void addBeams(LTCSpan<const Beam> beams);
+    void addFaces(LTCSpan<const Face> faces);
+
+    //! Multiplies every node by factor in one vectorized pass.
+    /*!
+    Positions always, radii unless -1, orientation only on oriented
+    nodes -- the same rules addNode follows. Units are not touched, e.g.
+    scaleNodes(1.0 / getUnitScale(LTCUnits::IN)) gives inch values.
+    */
+    void scaleNodes(double factor);
+
+    //! mm per unit, the factor addNode applies.
+    static double getUnitScale(LTCUnits units);
+
+    //Capacity hints for graphs built element by element.
+    void reserve(size_t numOfNodes, size_t numOfBeams = 0, size_t numOfFaces = 0);
+
+    const std::vector<Node>& getNodes()const;
     const std::vector<Beam>& getBeams()const { return mBeams; }
     const std::vector<Face>& getFaces()const { return mFaces; }
 
@@ -119,18 +237,92 @@ namespace LTC {
     int getID()const { return mID; }
     LTCUnits getUnits()const { return mUnits; }
 
-    void setNodes(const std::vector<Node>& nodes) { mNodes = nodes; }
-    void setBeams(const std::vector<Beam>& beams) { mBeams = beams; }
+    void setNodes(const std::vector<Node>& nodes);
+    void setBeams(const std::vector<Beam>& beams) { mBeams = beams; mAdjacency = nullptr; }
     void setFaces(const std::vector<Face>& faces) { mFaces = faces; }
 
+    void setNodes(std::vector<Node>&& nodes);
+    void setBeams(std::vector<Beam>&& beams) { mBeams = std::move(beams); mAdjacency = nullptr; }
+    void setFaces(std::vector<Face>&& faces) { mFaces = std::move(faces); }
+
+    //Node storage layout, switching converts the nodes already in the graph.
+    //AOS also sets the precision back to FLOAT64.
+    void setNodeStorage(LTCNodeStorage storage);
+    LTCNodeStorage getNodeStorage()const { return mNodeStorage; }
+
+    //Node precision, switching converts the nodes already in the graph.
+    //FLOAT32 also sets the storage to SOA.
+    void setNodePrecision(LTCNodePrecision precision);
+    LTCNodePrecision getNodePrecision()const { return mNodePrecision; }
+
+    //Layout independent node access.
+    size_t getNodeCount()const;
+    Node getNode(size_t idx)const;
+
+    //True if any node has orientation data (start != end).
+    bool isOriented()const;
+
+    //The SoA nodes, empty unless the storage is SOA in that precision.
+    const NodeArrays& getNodeArrays()const { return mNodeArrays; }
+    const NodeArraysF& getNodeArraysF()const { return mNodeArraysF; }
+    //Replace the nodes & switch to SOA in the matching precision.
+    void setNodeArrays(NodeArrays&& arrays);
+    void setNodeArrays(NodeArraysF&& arrays);
+
+    //! Node to beam adjacency, built on numOfThreads threads on first use.
+    /*!
+    Kept until the beams change (addBeam, addBeams, setBeams) or the node
+    count does; holders of the returned pointer keep their copy. Like the
+    getNodes cache it is not safe to build from several threads at once.
+    */
+    std::shared_ptr<const LTCAdjacency> getAdjacency(unsigned int numOfThreads = 0)const;
+
+    //! Merges nodes within tolerance of each other & drops the beams & faces that collapse.
+    /*!
+    Nodes within tolerance of each other are grouped transitively (a row
+    of nodes each within tolerance of the next becomes one node) & every
+    group keeps the data of its lowest indexed node; the remaining nodes
+    keep their order. Beams are remapped & dropped when degenerate or a duplicate of
+    an earlier beam; faces are remapped, quads with two merged corners
+    become triangles & faces with fewer than 3 corners are dropped.
+    Tolerance 0 merges exactly coincident nodes only.
+
+    Uses an LTCNodeGrid built on numOfThreads threads. If nodeMap is given
+    it receives the new index of every old node.
+    */
+    LTCWeldStats weld(double tolerance, unsigned int numOfThreads = 0,
+                      std::vector<int>* nodeMap = nullptr);
+
+    //! Renumbers the nodes so nodes close in space (or along beams) are close in memory.
+    /*!
+    Beam & face indices are remapped, their order is kept. Indices out of
+    range are left as they are. If nodeMap is given it receives the new
+    index of every old node.
+    */
+    void reorderNodes(LTCNodeOrder order, unsigned int numOfThreads = 0,
+                      std::vector<int>* nodeMap = nullptr);
+
   private:
+    void pushNode(const Node& node);
+    void invalidateNodeCache();
+    std::vector<Node> takeNodes();
+    //Keeps node order[i] as node i, in the current storage.
+    void gatherNodes(const std::vector<int>& order);
+
     std::string mName;
     LTCUnits mUnits;
 
     int mID;
-    std::vector<Node> mNodes;
+    LTCNodeStorage mNodeStorage;
+    LTCNodePrecision mNodePrecision;
+    NodeArrays mNodeArrays;
+    NodeArraysF mNodeArraysF;
+    //AoS nodes, or the getNodes cache in SoA mode
+    mutable std::vector<Node> mNodes;
+    mutable bool mNodeCacheValid;
     std::vector<Beam> mBeams;
     std::vector<Face> mFaces;
+    mutable std::shared_ptr<const LTCAdjacency> mAdjacency;
 
   };
 
@@ -0,0 +1,172 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCGraphHandle.h"
+#include "LTCFile.h"
+
+#include <cstring>
+
+namespace LTC {
+
+  LTC_ERROR LTCGraphHandle::open(const char* path,
+                                 std::vector<std::shared_ptr<LTCGraphHandle>>& handles,
+                                 LTCNodeStorage storage,
+                                 LTCNodePrecision precision) {
+    auto file = openFile(path, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    char magic[sizeof(kBinaryMagic)];
+    bool isBinary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+      memcmp(magic, kBinaryMagic, sizeof(magic)) == 0;
+
+    auto newHandle = [&]() {
+      std::shared_ptr<LTCGraphHandle> handle(new LTCGraphHandle());
+      handle->mPath = path;
+      handle->mIsBinary = isBinary;
+      handle->mNodeStorage = storage;
+      handle->mNodePrecision = precision;
+      return handle;
+    };
+
+    auto err = LTC_ERROR::OK;
+    if ( isBinary ) {
+      LTCBinaryHeader header;
+      std::vector<LTCBinaryGraphEntry> entries;
+      err = LTCBinary::readTableOfContents(file, header, entries);
+      for ( size_t i = 0; err == LTC_ERROR::OK && i < entries.size(); i++ ) {
+        auto handle = newHandle();
+        auto& entry = entries[i];
+        auto& info = handle->mInfo;
+        handle->mBinaryEntry = entry;
+        err = LTCBinary::readName(file, entry, info.mName);
+        info.mID = entry.mID;
+        info.mUnits = entry.mUnits;
+        info.mType = static_cast<LTCModel::GRAPH_TYPE>(entry.mType);
+        info.mNumOfNodes = static_cast<size_t>(entry.mNodeCount);
+        info.mNumOfBeams = static_cast<size_t>(entry.mBeamCount);
+        info.mNumOfFaces = static_cast<size_t>(entry.mFaceCount);
+        if ( err == LTC_ERROR::OK ) {
+          handles.push_back(handle);
+        }
+      }
+    }
+    else {
+      LTCGraphIndex index;
+      err = LTCGraphIndex::open(path, index);
+      if ( err == LTC_ERROR::OK ) {
+        for ( auto& entry : index.getEntries() ) {
+          auto handle = newHandle();
+          handle->mTextEntry = entry;
+          handle->mInfo = entry.mInfo;
+          handles.push_back(handle);
+        }
+      }
+    }
+    fclose(file);
+    return err;
+  }
+
+  bool LTCGraphHandle::isLoaded()const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLoaded;
+  }
+
+  LTC_ERROR LTCGraphHandle::getGraph(LTCGraphP& graph) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if ( !mLoaded ) {
+      mError = load();
+      mLoaded = true;
+    }
+    graph = mGraph;
+    return mError;
+  }
+
+  void LTCGraphHandle::unload() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mGraph = nullptr;
+    mError = LTC_ERROR::OK;
+    mLoaded = false;
+  }
+
+  LTC_ERROR LTCGraphHandle::load() {
+    auto file = openFile(mPath.c_str(), "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    LTC_ERROR err;
+    if ( mIsBinary ) {
+      err = LTCBinary::readGraph(file, mBinaryEntry, mGraph);
+      if ( err == LTC_ERROR::OK ) {
+        //same as LTCModel::readFromBinary
+        if ( mNodePrecision != LTCNodePrecision::FLOAT32 ) {
+          mGraph->setNodeStorage(mNodeStorage);
+        }
+        mGraph->setNodePrecision(mNodePrecision);
+      }
+    }
+    else {
+      err = LTCGraphIndex::readGraph(file, mTextEntry, mNodeStorage, mNodePrecision, mGraph);
+      if ( err != LTC_ERROR::OK || !matchesInfo(mTextEntry.mInfo) ) {
+        //the file changed since it was indexed, find the graph again
+        LTCGraphIndex index;
+        err = LTCGraphIndex::build(mPath.c_str(), index);
+        const LTCGraphIndexEntry* entry = nullptr;
+        for ( auto& candidate : index.getEntries() ) {
+          if ( candidate.mInfo.mID == mInfo.mID && candidate.mInfo.mName == mInfo.mName ) {
+            entry = &candidate;
+            break;
+          }
+        }
+        if ( err == LTC_ERROR::OK && !entry ) {
+          err = LTC_ERROR::LTC_NO_LATTICE;
+        }
+        if ( err == LTC_ERROR::OK ) {
+          mTextEntry = *entry;
+          err = LTCGraphIndex::readGraph(file, mTextEntry, mNodeStorage, mNodePrecision, mGraph);
+        }
+      }
+    }
+    if ( err == LTC_ERROR::OK && !matchesInfo(mIsBinary ? mInfo : mTextEntry.mInfo) ) {
+      err = LTC_ERROR::LTC_NO_LATTICE;
+    }
+    fclose(file);
+    if ( err != LTC_ERROR::OK ) {
+      mGraph = nullptr;
+    }
+    return err;
+  }
+
+  bool LTCGraphHandle::matchesInfo(const LTCGraphInfo& indexed)const {
+    if ( !mGraph ) {
+      //skipped by the reader, fine as long as the index agrees
+      return indexed.mNumOfBeams == 0 && indexed.mNumOfFaces == 0;
+    }
+    return mGraph->getID() == mInfo.mID && mGraph->getName() == mInfo.mName;
+  }
+
+}//namespace LTC
@@ -0,0 +1,109 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCBinary.h"
+#include "LTCGraphIndex.h"
+#include "LTCModel.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCGraphHandle
+  /*!
+  A graph of a lattice file that is only parsed when first asked for.
+  The handle knows the graph's LTCGraphInfo & where its data sits in the
+  file (an LTCGraphIndex entry for .ltcx, the table of contents entry for
+  .ltcb); getGraph reads it once & keeps it. Handles may be loaded from
+  several threads at once.
+
+  Example Use:
+  std::vector<std::shared_ptr<LTCGraphHandle>> handles;
+  auto err = LTCGraphHandle::open("lattice.ltcx", handles);
+  auto name = handles[0]->getInfo().mName; //nothing parsed yet
+  std::shared_ptr<LTCGraph> graph;
+  err = handles[0]->getGraph(graph);       //parses this graph only
+  */
+  class LTCGraphHandle {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    //! One handle per graph of the file at path, appended in file order.
+    /*!
+    .ltcx files are indexed with LTCGraphIndex::open, so a current sidecar
+    makes this a single small read.
+    */
+    static LTC_ERROR open(const char* path, std::vector<std::shared_ptr<LTCGraphHandle>>& handles,
+                          LTCNodeStorage storage = LTCNodeStorage::AOS,
+                          LTCNodePrecision precision = LTCNodePrecision::FLOAT64);
+
+    const LTCGraphInfo& getInfo()const { return mInfo; }
+    bool isLoaded()const;
+
+    //! Parses the graph on first use, later calls return the same graph or error.
+    /*!
+    graph is nullptr for graphs with neither beams nor faces, which the
+    readers skip. If an .ltcx file changed since it was indexed the graph
+    with the same id & name is looked up again; LTC_NO_LATTICE if the
+    file no longer holds it.
+    */
+    LTC_ERROR getGraph(LTCGraphP& graph);
+
+    //! Drops the parsed graph, the next getGraph reads it again.
+    void unload();
+
+  private:
+    LTCGraphHandle() :
+      mIsBinary(false),
+      mNodeStorage(LTCNodeStorage::AOS),
+      mNodePrecision(LTCNodePrecision::FLOAT64),
+      mLoaded(false),
+      mError(LTC_ERROR::OK) {}
+
+    LTC_ERROR load();
+    //! The parsed graph has mInfo's id & name, indexed holds the counts
+    //! the entry it was read from expects.
+    bool matchesInfo(const LTCGraphInfo& indexed)const;
+
+    std::string mPath;
+    LTCGraphInfo mInfo;
+    bool mIsBinary;
+    LTCGraphIndexEntry mTextEntry;
+    LTCBinaryGraphEntry mBinaryEntry;
+    LTCNodeStorage mNodeStorage;
+    LTCNodePrecision mNodePrecision;
+
+    mutable std::mutex mMutex;
+    bool mLoaded;
+    LTC_ERROR mError;
+    LTCGraphP mGraph;
+  };
+
+}//namespace LTC
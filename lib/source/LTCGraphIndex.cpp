@@ -0,0 +1,264 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCGraphIndex.h"
+#include "LTCFile.h"
+#include "LTCGraphView.h"
+#include "LTCNumber.h"
+#include "LTCParallelReader.h"
+#include "LTCStreamReader.h"
+#include "LTCStreamWriter.h"
+#include "LTCZip.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+
+namespace LTC {
+
+  namespace {
+    bool toUInt64(const LTCXmlAttribute* attribute, uint64_t& value) {
+      if ( !attribute ) {
+        return false;
+      }
+      std::string text(attribute->mValue, attribute->mValueLength);
+      char* end = nullptr;
+      value = strtoull(text.c_str(), &end, 10);
+      return !text.empty() && *end == 0;
+    }
+  }
+
+  const size_t LTCGraphIndex::kSampleSize;
+
+  LTC_ERROR LTCGraphIndex::build(const char* path, LTCGraphIndex& index) {
+    LTC_ERROR err;
+    auto file = LTCMappedFile::open(path, err);
+    if ( !file ) {
+      return err == LTC_ERROR::LTC_INVALID_BINARY ? LTC_ERROR::XML_ERROR_EMPTY_DOCUMENT : err;
+    }
+    auto text = reinterpret_cast<const char*>(file->data());
+    auto size = static_cast<size_t>(file->size());
+
+    std::vector<LTCTextRange> ranges;
+    if ( !LTCParallelReader::findGraphs(text, size, ranges) ) {
+      return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+    }
+    if ( ranges.empty() ) {
+      return LTC_ERROR::LTC_NO_LATTICE;
+    }
+    err = fingerprint(path, index.mFileSize, index.mFileTime, index.mFileCrc);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+    index.mEntries.clear();
+    index.mEntries.reserve(ranges.size());
+    for ( auto& range : ranges ) {
+      std::vector<LTCGraphInfo> infos;
+      err = LTCModel::scanText(text + range.mBegin, range.mEnd - range.mBegin, infos);
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+      LTCGraphIndexEntry entry;
+      entry.mOffset = range.mBegin;
+      entry.mLength = range.mEnd - range.mBegin;
+      entry.mInfo = infos.front();
+      index.mEntries.push_back(entry);
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCGraphIndex::open(const char* path, LTCGraphIndex& index, bool* fromSidecar) {
+    uint64_t fileSize, fileTime;
+    uint32_t fileCrc;
+    auto err = fingerprint(path, fileSize, fileTime, fileCrc);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+
+    bool current = index.load(sidecarPath(path).c_str()) == LTC_ERROR::OK &&
+      index.mFileSize == fileSize && index.mFileTime == fileTime && index.mFileCrc == fileCrc;
+    if ( fromSidecar ) {
+      *fromSidecar = current;
+    }
+    return current ? LTC_ERROR::OK : build(path, index);
+  }
+
+  LTC_ERROR LTCGraphIndex::fingerprint(const char* path, uint64_t& size,
+                                       uint64_t& time, uint32_t& crc) {
+    auto file = openFile(path, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    std::vector<unsigned char> sample(kSampleSize);
+    bool ok = LTC::getFileSize(file, size) && LTC::getFileTime(path, time);
+    //head then tail, they overlap in files under 2 samples
+    size_t count = static_cast<size_t>(std::min<uint64_t>(size, kSampleSize));
+    ok = ok && fread(sample.data(), 1, count, file) == count;
+    crc = crc32(sample.data(), count);
+    ok = ok && seekFile(file, size - count) && fread(sample.data(), 1, count, file) == count;
+    crc = crc32(sample.data(), count, crc);
+    fclose(file);
+    return ok ? LTC_ERROR::OK : LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+  }
+
+  LTC_ERROR LTCGraphIndex::save(const char* indexPath)const {
+    auto file = openFile(indexPath, "wb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+    bool ok = fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<ltcindex version=\"2\" size=\"%" PRIu64 "\" time=\"%" PRIu64 "\""
+                      " crc=\"%" PRIu32 "\">\n", mFileSize, mFileTime, mFileCrc) > 0;
+    for ( auto& entry : mEntries ) {
+      auto& info = entry.mInfo;
+      std::string name;
+      LTCStreamWriter::appendEscaped(name, info.mName.c_str());
+      ok = ok && fprintf(file, "    <graph offset=\"%" PRIu64 "\" length=\"%" PRIu64 "\""
+                         " id=\"%d\" name=\"%s\" units=\"%d\" type=\"%d\""
+                         " nodes=\"%" PRIu64 "\" beams=\"%" PRIu64 "\" faces=\"%" PRIu64 "\"/>\n",
+                         entry.mOffset, entry.mLength,
+                         info.mID, name.c_str(), static_cast<int>(info.mUnits), static_cast<int>(info.mType),
+                         static_cast<uint64_t>(info.mNumOfNodes),
+                         static_cast<uint64_t>(info.mNumOfBeams),
+                         static_cast<uint64_t>(info.mNumOfFaces)) > 0;
+    }
+    ok = ok && fprintf(file, "</ltcindex>\n") > 0;
+    if ( fclose(file) != 0 ) {
+      ok = false;
+    }
+    return ok ? LTC_ERROR::OK : LTC_ERROR::LTC_FILE_WRITE_ERROR;
+  }
+
+  LTC_ERROR LTCGraphIndex::load(const char* indexPath) {
+    auto file = openFile(indexPath, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    LTCXmlScanner scanner(file);
+    LTCXmlTag tag;
+    bool hasHeader = false;
+    auto err = LTC_ERROR::OK;
+    mEntries.clear();
+    while ( err == LTC_ERROR::OK && scanner.next(tag) ) {
+      if ( tag.mKind == LTCXmlTag::END ) {
+        continue;
+      }
+      if ( tag.is("ltcindex") ) {
+        auto version = tag.find("version");
+        uint64_t crc = 0;
+        hasHeader = version && version->valueIs("2") && toUInt64(tag.find("size"), mFileSize) &&
+          toUInt64(tag.find("time"), mFileTime) &&
+          toUInt64(tag.find("crc"), crc) && crc <= 0xffffffffu;
+        mFileCrc = static_cast<uint32_t>(crc);
+        if ( !hasHeader ) {
+          err = LTC_ERROR::LTC_UNSUPPORTED_VERSION;
+        }
+      }
+      else if ( tag.is("graph") && hasHeader ) {
+        LTCGraphIndexEntry entry;
+        auto& info = entry.mInfo;
+        uint64_t units, type, nodes, beams, faces;
+        auto name = tag.find("name");
+        auto idAttribute = tag.find("id");
+        bool ok = idAttribute &&
+          parseInt(idAttribute->mValue, idAttribute->mValue + idAttribute->mValueLength, info.mID) &&
+          toUInt64(tag.find("offset"), entry.mOffset) &&
+          toUInt64(tag.find("length"), entry.mLength) &&
+          toUInt64(tag.find("units"), units) && units <= uint64_t(LTCUnits::FT) &&
+          toUInt64(tag.find("type"), type) && type <= uint64_t(LTCModel::RIB) &&
+          toUInt64(tag.find("nodes"), nodes) &&
+          toUInt64(tag.find("beams"), beams) &&
+          toUInt64(tag.find("faces"), faces) && name;
+        if ( !ok ) {
+          err = LTC_ERROR::XML_ERROR_PARSING_ATTRIBUTE;
+          break;
+        }
+        info.mName = LTCStreamReader::decodeValue(*name);
+        info.mUnits = static_cast<LTCUnits>(units);
+        info.mType = static_cast<LTCModel::GRAPH_TYPE>(type);
+        info.mNumOfNodes = static_cast<size_t>(nodes);
+        info.mNumOfBeams = static_cast<size_t>(beams);
+        info.mNumOfFaces = static_cast<size_t>(faces);
+        mEntries.push_back(entry);
+      }
+    }
+    if ( err == LTC_ERROR::OK ) {
+      err = scanner.getError();
+    }
+    if ( err == LTC_ERROR::OK && !hasHeader ) {
+      err = LTC_ERROR::XML_ERROR_EMPTY_DOCUMENT;
+    }
+    fclose(file);
+    return err;
+  }
+
+  LTC_ERROR LTCGraphIndex::readGraph(FILE* file, const LTCGraphIndexEntry& entry,
+                                     LTCNodeStorage storage, LTCNodePrecision precision,
+                                     std::shared_ptr<LTCGraph>& graph) {
+    graph = nullptr;
+    std::vector<char> text(static_cast<size_t>(entry.mLength));
+    if ( !seekFile(file, entry.mOffset) ||
+        fread(text.data(), 1, text.size(), file) != text.size() ) {
+      return LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+    }
+    LTCXmlScanner scanner(text.data(), text.size());
+    LTCStreamReader reader(scanner, storage, precision);
+    std::vector<std::shared_ptr<LTCGraph>> graphs;
+    auto err = reader.read(graphs);
+    if ( err == LTC_ERROR::OK && graphs.size() > 1 ) {
+      //the range doesn't hold a single graph, the index is stale
+      err = LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+    }
+    if ( err == LTC_ERROR::OK && !graphs.empty() ) {
+      graph = graphs.front();
+    }
+    return err;
+  }
+
+  std::string LTCGraphIndex::sidecarPath(const char* path) {
+    return std::string(path) + ".idx";
+  }
+
+  const LTCGraphIndexEntry* LTCGraphIndex::find(int id)const {
+    for ( auto& entry : mEntries ) {
+      if ( entry.mInfo.mID == id ) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  const LTCGraphIndexEntry* LTCGraphIndex::find(const std::string& name)const {
+    for ( auto& entry : mEntries ) {
+      if ( entry.mInfo.mName == name ) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+}//namespace LTC
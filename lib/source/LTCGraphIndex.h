@@ -0,0 +1,115 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#pragma once
+#include "LTCModel.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCGraphIndexEntry
+  /*!
+  Where a top level <graph> sits in an .ltcx file: mOffset is the '<' of
+  its start tag, mLength runs through its end tag.
+  */
+  struct LTCGraphIndexEntry {
+    uint64_t mOffset;
+    uint64_t mLength;
+    LTCGraphInfo mInfo;
+  };
+
+  //! LTCGraphIndex
+  /*!
+  Byte ranges of the graphs in an .ltcx file, so a single graph can be
+  parsed without reading the others. Building one is a single pass over
+  the tags; saved as a sidecar (sidecarPath) it is reused for as long as
+  the file keeps the size, modification time & sampled CRC it was built
+  for. The CRC covers the first & last kSampleSize bytes, so it catches
+  same size edits near either end even within the time stamp's second.
+
+  Sidecar layout, units & type are the LTCUnits / GRAPH_TYPE values:
+    <ltcindex version="2" size="file size" time="modification time" crc="sampled CRC-32">
+        <graph offset="" length="" id="" name="" units="" type="" nodes="" beams="" faces=""/>
+    </ltcindex>
+
+  Binary files don't need one, their table of contents already holds the
+  offsets (LTCBinary.h).
+  */
+  class LTCGraphIndex {
+  public:
+    LTCGraphIndex() :
+      mFileSize(0),
+      mFileTime(0),
+      mFileCrc(0) {}
+
+    static const size_t kSampleSize = 1 << 16;
+
+    //! Indexes the .ltcx file at path.
+    static LTC_ERROR build(const char* path, LTCGraphIndex& index);
+
+    //! The sidecar of path if it is current, otherwise a freshly built index.
+    static LTC_ERROR open(const char* path, LTCGraphIndex& index, bool* fromSidecar = nullptr);
+
+    LTC_ERROR save(const char* indexPath)const;
+    LTC_ERROR load(const char* indexPath);
+
+    //! path + ".idx"
+    static std::string sidecarPath(const char* path);
+
+    //! Parses the graph of one entry from the indexed file.
+    /*!
+    graph is set to nullptr if the graph has neither beams nor faces, as
+    the streaming reader does.
+    */
+    static LTC_ERROR readGraph(FILE* file, const LTCGraphIndexEntry& entry,
+                               LTCNodeStorage storage, LTCNodePrecision precision,
+                               std::shared_ptr<LTCGraph>& graph);
+
+    //! First graph with the given id / name, nullptr if there is none.
+    const LTCGraphIndexEntry* find(int id)const;
+    const LTCGraphIndexEntry* find(const std::string& name)const;
+
+    uint64_t getFileSize()const { return mFileSize; }
+    uint64_t getFileTime()const { return mFileTime; }
+    uint32_t getFileCrc()const { return mFileCrc; }
+    const std::vector<LTCGraphIndexEntry>& getEntries()const { return mEntries; }
+
+  private:
+    //! Size, time & sampled CRC of the file at path as the sidecar records them.
+    static LTC_ERROR fingerprint(const char* path, uint64_t& size, uint64_t& time, uint32_t& crc);
+
+    uint64_t mFileSize;
+    uint64_t mFileTime;
+    uint32_t mFileCrc;
+    std::vector<LTCGraphIndexEntry> mEntries;
+  };
+
+}//namespace LTC
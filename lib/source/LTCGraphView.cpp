@@ -0,0 +1,196 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCGraphView.h"
+#include "LTCBinary.h"
+#include "LTCFile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LTC {
+
+  std::shared_ptr<LTCMappedFile> LTCMappedFile::open(const char* path, LTC_ERROR& err) {
+    std::shared_ptr<LTCMappedFile> mapped(new LTCMappedFile());
+    err = LTC_ERROR::OK;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if ( file == INVALID_HANDLE_VALUE ) {
+      err = LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+      return nullptr;
+    }
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx(file, &size) || size.QuadPart == 0 ) {
+      CloseHandle(file);
+      err = LTC_ERROR::LTC_INVALID_BINARY;
+      return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file); //the mapping keeps the file open
+    if ( !mapping ) {
+      err = LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+      return nullptr;
+    }
+    auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if ( !view ) {
+      CloseHandle(mapping);
+      err = LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+      return nullptr;
+    }
+    mapped->mHandle = mapping;
+    mapped->mData = static_cast<const unsigned char*>(view);
+    mapped->mSize = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if ( fd < 0 ) {
+      err = LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+      return nullptr;
+    }
+    struct stat info;
+    if ( fstat(fd, &info) != 0 || info.st_size == 0 ) {
+      ::close(fd);
+      err = LTC_ERROR::LTC_INVALID_BINARY;
+      return nullptr;
+    }
+    auto view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); //the mapping keeps the file open
+    if ( view == MAP_FAILED ) {
+      err = LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+      return nullptr;
+    }
+    mapped->mData = static_cast<const unsigned char*>(view);
+    mapped->mSize = static_cast<uint64_t>(info.st_size);
+#endif
+    return mapped;
+  }
+
+  LTCMappedFile::~LTCMappedFile() {
+    if ( !mData ) {
+      return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(mData);
+    CloseHandle(static_cast<HANDLE>(mHandle));
+#else
+    munmap(const_cast<unsigned char*>(mData), static_cast<size_t>(mSize));
+#endif
+  }
+
+  LTC_ERROR LTCGraphView::open(const char* path, std::vector<LTCGraphViewP>& views) {
+    if ( !isLittleEndian() ) {
+      return LTC_ERROR::LTC_INVALID_BINARY;
+    }
+
+    LTC_ERROR err;
+    auto file = LTCMappedFile::open(path, err);
+    if ( !file ) {
+      return err;
+    }
+
+    LTCBinaryHeader header;
+    err = LTCBinary::decodeHeader(file->data(), file->size(), header);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+
+    std::vector<LTCGraphViewP> newViews;
+    for ( uint32_t i = 0; i < header.mGraphCount; i++ ) {
+      LTCBinaryGraphEntry entry;
+      err = LTCBinary::decodeEntry(file->data() + header.mTocOffset + uint64_t(kBinaryEntrySize) * i,
+                                   file->size(), entry);
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+      //spans need naturally aligned arrays, the writer aligns to kBinaryAlignment
+      if ( entry.mNodeOffset % alignof(Node) != 0 ||
+          entry.mBeamOffset % alignof(Beam) != 0 ||
+          entry.mFaceOffset % alignof(Face) != 0 ) {
+        return LTC_ERROR::LTC_INVALID_BINARY;
+      }
+
+      LTCGraphViewP view(new LTCGraphView());
+      auto base = file->data();
+      view->mFile = file;
+      view->mName.assign(reinterpret_cast<const char*>(base + entry.mNameOffset),
+                         static_cast<size_t>(entry.mNameLength));
+      view->mID = entry.mID;
+      view->mUnits = entry.mUnits;
+      view->mNodeFormat = entry.mNodeFormat;
+      auto count = static_cast<size_t>(entry.mNodeCount);
+      if ( entry.mNodeFormat == LTCNodeFormat::AOS_F64 ) {
+        view->mNodes = LTCSpan<const Node>(reinterpret_cast<const Node*>(base + entry.mNodeOffset),
+                                           count);
+      }
+      else {
+        auto fields = reinterpret_cast<const float*>(base + entry.mNodeOffset);
+        size_t numOfFields = entry.mNodeFormat == LTCNodeFormat::SOA_F32_ORIENTED ? 10 : 4;
+        for ( size_t f = 0; f < numOfFields; f++ ) {
+          view->mNodeFields[f] = LTCSpan<const float>(fields + f * count, count);
+        }
+      }
+      view->mBeams = LTCSpan<const Beam>(reinterpret_cast<const Beam*>(base + entry.mBeamOffset),
+                                         static_cast<size_t>(entry.mBeamCount));
+      view->mFaces = LTCSpan<const Face>(reinterpret_cast<const Face*>(base + entry.mFaceOffset),
+                                         static_cast<size_t>(entry.mFaceCount));
+      newViews.push_back(view);
+    }
+    views.insert(views.end(), newViews.begin(), newViews.end());
+    return LTC_ERROR::OK;
+  }
+
+  std::shared_ptr<LTCGraph> LTCGraphView::toGraph()const {
+    auto graph = LTCGraph::create(mName, mID, mUnits);
+    if ( mNodeFormat == LTCNodeFormat::AOS_F64 ) {
+      graph->setNodes(std::vector<Node>(mNodes.begin(), mNodes.end()));
+    }
+    else {
+      NodeArraysF nodes;
+      std::vector<float>* fields[] = {
+        &nodes.mX, &nodes.mY, &nodes.mZ, &nodes.mRadius,
+        &nodes.mXS, &nodes.mYS, &nodes.mZS, &nodes.mXE, &nodes.mYE, &nodes.mZE
+      };
+      for ( size_t f = 0; f < 10; f++ ) {
+        fields[f]->assign(mNodeFields[f].begin(), mNodeFields[f].end());
+      }
+      graph->setNodeArrays(std::move(nodes));
+    }
+    graph->setBeams(std::vector<Beam>(mBeams.begin(), mBeams.end()));
+    graph->setFaces(std::vector<Face>(mFaces.begin(), mFaces.end()));
+    return graph;
+  }
+
+}//namespace LTC
@@ -0,0 +1,122 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCBinary.h"
+#include "LTCModel.h"
+#include "LTCSpan.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCMappedFile
+  /*!
+  Read-only memory mapping of a whole file. Pages are shared through the OS
+  page cache by every process mapping the same file.
+  */
+  class LTCMappedFile {
+  public:
+    static std::shared_ptr<LTCMappedFile> open(const char* path, LTC_ERROR& err);
+
+    LTCMappedFile(const LTCMappedFile&) = delete;
+    LTCMappedFile& operator=(const LTCMappedFile&) = delete;
+    ~LTCMappedFile();
+
+    const unsigned char* data()const { return mData; }
+    uint64_t size()const { return mSize; }
+
+  private:
+    LTCMappedFile() :
+      mData(nullptr),
+      mSize(0),
+      mHandle(nullptr) {}
+
+    const unsigned char* mData;
+    uint64_t mSize;
+    void* mHandle; //mapping handle on Windows
+  };
+
+  //! LTCGraphView
+  /*!
+  Read-only graph over a mapped binary lattice (.ltcb) file. Nodes, beams &
+  faces point directly into the mapped pages, nothing is copied. Views keep
+  the mapping alive, so they can outlive the vector they were opened into.
+
+  Example Use:
+  std::vector<std::shared_ptr<LTCGraphView>> views;
+  auto err = LTCGraphView::open("lattice.ltcb", views);
+  for ( auto& n : views[0]->getNodes() ) { ... }
+  */
+  class LTCGraphView {
+    typedef std::shared_ptr<LTCGraphView> LTCGraphViewP;
+  public:
+    //! Opens one view per graph in the file.
+    /*!
+    Requires a little-endian host, returns LTC_INVALID_BINARY otherwise.
+    */
+    static LTC_ERROR open(const char* path, std::vector<LTCGraphViewP>& views);
+
+    //Empty unless getNodeFormat() is AOS_F64.
+    LTCSpan<const Node> getNodes()const { return mNodes; }
+    LTCSpan<const Beam> getBeams()const { return mBeams; }
+    LTCSpan<const Face> getFaces()const { return mFaces; }
+
+    const std::string& getName()const { return mName; }
+    int getID()const { return mID; }
+    LTCUnits getUnits()const { return mUnits; }
+
+    //! float32 node arrays of the SOA_F32 formats.
+    /*!
+    field indexes { x, y, z, r, xs, ys, zs, xe, ye, ze }, fields that are
+    not in the file are empty.
+    */
+    LTCNodeFormat getNodeFormat()const { return mNodeFormat; }
+    LTCSpan<const float> getNodeField(size_t field)const { return mNodeFields[field]; }
+
+    //! Copies the view into a regular, editable graph.
+    std::shared_ptr<LTCGraph> toGraph()const;
+
+  private:
+    LTCGraphView() {}
+
+    std::shared_ptr<LTCMappedFile> mFile;
+    std::string mName;
+    int mID;
+    LTCUnits mUnits;
+    LTCNodeFormat mNodeFormat;
+    LTCSpan<const Node> mNodes;
+    LTCSpan<const float> mNodeFields[10];
+    LTCSpan<const Beam> mBeams;
+    LTCSpan<const Face> mFaces;
+  };
+
+}//namespace LTC
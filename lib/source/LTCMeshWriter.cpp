@@ -0,0 +1,216 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCMeshWriter.h"
+#include "LTCParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace LTC {
+
+  namespace {
+    const size_t kBlockSize = 1 << 14;
+    const size_t kStlHeaderSize = 80;
+    const size_t kStlTriangleSize = 50;  //normal, 3 vertices, attribute count
+    const size_t kPlyVertexSize = 12;
+    const size_t kPlyFaceSize = 13;      //count byte, 3 indices
+
+    void putU32(unsigned char* p, uint32_t v) {
+      p[0] = static_cast<unsigned char>(v);
+      p[1] = static_cast<unsigned char>(v >> 8);
+      p[2] = static_cast<unsigned char>(v >> 16);
+      p[3] = static_cast<unsigned char>(v >> 24);
+    }
+
+    void putF32(unsigned char* p, float v) {
+      uint32_t bits;
+      memcpy(&bits, &v, sizeof(bits));
+      putU32(p, bits);
+    }
+  }
+
+  LTCMeshWriter::LTCMeshWriter(FILE* file,
+                               LTCMeshFormat format,
+                               const LTCMeshOptions& options) :
+    mFile(file),
+    mFormat(format),
+    mOptions(options),
+    mChunkSize(1 << 20) {}
+
+  LTC_ERROR LTCMeshWriter::write(const std::vector<LTCGraphP>& graphs) {
+    std::vector<LTCBeamMesherP> meshers;
+    for ( auto& graph : graphs ) {
+      meshers.push_back(LTCBeamMesher::create(*graph, mOptions));
+    }
+    return mFormat == LTCMeshFormat::PLY ? writePly(meshers) : writeStl(meshers);
+  }
+
+  LTC_ERROR LTCMeshWriter::writeStl(const std::vector<LTCBeamMesherP>& meshers) {
+    uint64_t numOfTriangles = 0;
+    for ( auto& mesher : meshers ) {
+      numOfTriangles += mesher->getTriangleCount();
+    }
+    if ( numOfTriangles > std::numeric_limits<uint32_t>::max() ) {
+      return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+    }
+    //the header must not start with "solid", readers take that for ASCII
+    unsigned char header[kStlHeaderSize + 4];
+    memset(header, ' ', kStlHeaderSize);
+    const char* title = "binary STL, LTCX lattice mesh, mm";
+    memcpy(header, title, strlen(title));
+    putU32(header + kStlHeaderSize, static_cast<uint32_t>(numOfTriangles));
+    if ( !put(header, sizeof(header)) ) {
+      return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+    }
+    for ( auto& mesher : meshers ) {
+      if ( !writeChunks(*mesher, TRIANGLES, 0) ) {
+        return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+      }
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCMeshWriter::writePly(const std::vector<LTCBeamMesherP>& meshers) {
+    uint64_t numOfVertices = 0;
+    uint64_t numOfTriangles = 0;
+    for ( auto& mesher : meshers ) {
+      numOfVertices += mesher->getVertexCount();
+      numOfTriangles += mesher->getTriangleCount();
+    }
+    if ( numOfVertices > std::numeric_limits<uint32_t>::max() ) {
+      return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+    }
+    std::string header =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "comment LTCX lattice mesh, mm\n"
+      "element vertex " + std::to_string(numOfVertices) + "\n"
+      "property float x\n"
+      "property float y\n"
+      "property float z\n"
+      "element face " + std::to_string(numOfTriangles) + "\n"
+      "property list uchar uint vertex_indices\n"
+      "end_header\n";
+    if ( !put(header.data(), header.size()) ) {
+      return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+    }
+    for ( auto& mesher : meshers ) {
+      if ( !writeChunks(*mesher, VERTICES, 0) ) {
+        return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+      }
+    }
+    size_t firstVertex = 0;
+    for ( auto& mesher : meshers ) {
+      if ( !writeChunks(*mesher, TRIANGLES, firstVertex) ) {
+        return LTC_ERROR::LTC_FILE_WRITE_ERROR;
+      }
+      firstVertex += mesher->getVertexCount();
+    }
+    return LTC_ERROR::OK;
+  }
+
+  bool LTCMeshWriter::writeChunks(const LTCBeamMesher& mesher, Pass pass, size_t firstVertex) {
+    size_t numOfParts = mesher.getPartCount();
+    size_t chunkSize = std::max<size_t>(mChunkSize, 1);
+    bool stl = mFormat == LTCMeshFormat::STL;
+    size_t first = 0;
+    while ( first < numOfParts ) {
+      size_t last = first + 1;
+      while ( last < numOfParts && mesher.getTriangleCount(first, last + 1) <= chunkSize ) {
+        last++;
+      }
+      if ( !mesher.mesh(first, last, mMesh) ) {
+        return false;
+      }
+      //chunk indices start at 0
+      size_t chunkVertex = firstVertex + mesher.getVertexCount(0, first);
+      first = last;
+
+      //encode in blocks on the mesher's threads, then one write
+      size_t count = pass == VERTICES ? mMesh.getVertexCount() : mMesh.getTriangleCount();
+      size_t recordSize = pass == VERTICES ? kPlyVertexSize : (stl ? kStlTriangleSize : kPlyFaceSize);
+      mBuffer.resize(count * recordSize);
+      auto vertex = [&](uint32_t idx) {
+        return &mMesh.mVertices[3 * static_cast<size_t>(idx)];
+      };
+      size_t numOfBlocks = (count + kBlockSize - 1) / kBlockSize;
+      parallelFor(numOfBlocks, mOptions.mNumOfThreads, [&](size_t block) {
+        size_t end = std::min((block + 1) * kBlockSize, count);
+        for ( size_t i = block * kBlockSize; i < end; i++ ) {
+          unsigned char* out = &mBuffer[i * recordSize];
+          if ( pass == VERTICES ) {
+            for ( int k = 0; k < 3; k++ ) {
+              putF32(out + 4 * k, mMesh.mVertices[3 * i + k]);
+            }
+            continue;
+          }
+          const uint32_t* triangle = &mMesh.mTriangles[3 * i];
+          if ( !stl ) {
+            out[0] = 3;
+            for ( int k = 0; k < 3; k++ ) {
+              putU32(out + 1 + 4 * k, static_cast<uint32_t>(chunkVertex + triangle[k]));
+            }
+            continue;
+          }
+          const float* a = vertex(triangle[0]);
+          const float* b = vertex(triangle[1]);
+          const float* c = vertex(triangle[2]);
+          double e1[3], e2[3];
+          for ( int k = 0; k < 3; k++ ) {
+            e1[k] = static_cast<double>(b[k]) - a[k];
+            e2[k] = static_cast<double>(c[k]) - a[k];
+          }
+          double n[3] = { e1[1] * e2[2] - e1[2] * e2[1],
+                          e1[2] * e2[0] - e1[0] * e2[2],
+                          e1[0] * e2[1] - e1[1] * e2[0] };
+          double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+          for ( int k = 0; k < 3; k++ ) {
+            putF32(out + 4 * k, static_cast<float>(len > 0.0 ? n[k] / len : 0.0));
+            putF32(out + 12 + 4 * k, a[k]);
+            putF32(out + 24 + 4 * k, b[k]);
+            putF32(out + 36 + 4 * k, c[k]);
+          }
+          out[48] = 0;
+          out[49] = 0;
+        }
+      });
+      if ( !put(mBuffer.data(), mBuffer.size()) ) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool LTCMeshWriter::put(const void* data, size_t numOfBytes) {
+    return numOfBytes == 0 || fwrite(data, 1, numOfBytes, mFile) == numOfBytes;
+  }
+
+}//namespace LTC
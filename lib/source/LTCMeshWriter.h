@@ -0,0 +1,87 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCMesher.h"
+#include "LTCModel.h"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCMeshWriter
+  /*!
+  Writes the meshed graphs as one binary STL or PLY file without holding
+  the whole mesh: every graph gets an LTCBeamMesher, whose part counts
+  give the file header up front, then parts are meshed in chunks of about
+  setChunkSize() triangles, encoded & written one chunk after the other.
+  Memory is the meshers' part offsets plus one chunk.
+
+  PLY lists all vertices before the faces, so for PLY every chunk is
+  meshed twice, once for its vertices & once for its faces.
+
+  STL holds at most 2^32 - 1 triangles & PLY indices are 32 bit;
+  bigger meshes give LTC_FILE_WRITE_ERROR before anything is written.
+  */
+  class LTCMeshWriter {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    LTCMeshWriter(FILE* file,
+                  LTCMeshFormat format,
+                  const LTCMeshOptions& options = LTCMeshOptions());
+
+    LTC_ERROR write(const std::vector<LTCGraphP>& graphs);
+
+    //! Triangles per chunk, a chunk is never less than one part.
+    void setChunkSize(size_t numOfTriangles) { mChunkSize = numOfTriangles; }
+
+  private:
+    typedef std::shared_ptr<LTCBeamMesher> LTCBeamMesherP;
+
+    enum Pass {
+      VERTICES = 0,
+      TRIANGLES = 1
+    };
+
+    LTC_ERROR writeStl(const std::vector<LTCBeamMesherP>& meshers);
+    LTC_ERROR writePly(const std::vector<LTCBeamMesherP>& meshers);
+    //! Meshes & writes every chunk of mesher, vertex indices offset by firstVertex.
+    bool writeChunks(const LTCBeamMesher& mesher, Pass pass, size_t firstVertex);
+    bool put(const void* data, size_t numOfBytes);
+
+    FILE* mFile;
+    LTCMeshFormat mFormat;
+    LTCMeshOptions mOptions;
+    size_t mChunkSize;
+    LTCMesh mMesh;
+    std::vector<unsigned char> mBuffer;
+  };
+
+}//namespace LTC
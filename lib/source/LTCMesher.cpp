@@ -0,0 +1,718 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCMesher.h"
+#include "LTCAdjacency.h"
+#include "LTCParallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace LTC {
+
+  namespace {
+    const size_t kBlockSize = 1 << 12;
+    const double kPi = 3.14159265358979323846;
+
+    struct Vec3 {
+      double x, y, z;
+    };
+
+    inline Vec3 operator+(const Vec3& a, const Vec3& b) { return Vec3{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+    inline Vec3 operator-(const Vec3& a, const Vec3& b) { return Vec3{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+    inline Vec3 operator*(const Vec3& a, double s) { return Vec3{ a.x * s, a.y * s, a.z * s }; }
+    inline double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline Vec3 cross(const Vec3& a, const Vec3& b) {
+      return Vec3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    }
+    inline double length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+
+    inline Vec3 position(const Node& node) { return Vec3{ node.mX, node.mY, node.mZ }; }
+
+    //! Two unit vectors perpendicular to unit axis & each other, u x v = axis.
+    void getFrame(const Vec3& axis, Vec3& u, Vec3& v) {
+      //cross with the world axis least aligned with axis
+      Vec3 other = std::fabs(axis.x) <= std::fabs(axis.y) && std::fabs(axis.x) <= std::fabs(axis.z)
+        ? Vec3{ 1.0, 0.0, 0.0 }
+        : (std::fabs(axis.y) <= std::fabs(axis.z) ? Vec3{ 0.0, 1.0, 0.0 } : Vec3{ 0.0, 0.0, 1.0 });
+      u = cross(axis, other);
+      u = u * (1.0 / length(u));
+      v = cross(axis, u);
+    }
+
+    //! Convex hull of points (x, y, z each), as outward facing triangles.
+    /*!
+    Quickhull: every face keeps the points outside it, the farthest one
+    is added next & only the faces it sees (found across neighbours) are
+    replaced. Returns false if the points are (nearly) flat.
+    */
+    bool getConvexHull(const std::vector<double>& coords, std::vector<uint32_t>& triangles) {
+      const uint32_t kNone = UINT32_MAX;
+      struct Face {
+        uint32_t v[3];
+        uint32_t neighbor[3];  //across edge v[e] -> v[e + 1]
+        Vec3 normal;
+        double offset;
+        uint32_t outside;      //first point outside, chained through next
+        bool alive;
+      };
+      size_t numOfPoints = coords.size() / 3;
+      auto point = [&](size_t i) {
+        return Vec3{ coords[3 * i], coords[3 * i + 1], coords[3 * i + 2] };
+      };
+      triangles.clear();
+      if ( numOfPoints < 4 ) {
+        return false;
+      }
+
+      //initial tetrahedron from extreme points
+      size_t p0 = 0;
+      for ( size_t i = 1; i < numOfPoints; i++ ) {
+        if ( point(i).x < point(p0).x ) {
+          p0 = i;
+        }
+      }
+      size_t p1 = p0;
+      double best = 0.0;
+      for ( size_t i = 0; i < numOfPoints; i++ ) {
+        double d = length(point(i) - point(p0));
+        if ( d > best ) {
+          best = d;
+          p1 = i;
+        }
+      }
+      double eps = best * 1e-9;
+      if ( !(best > 0.0) ) {
+        return false;
+      }
+      Vec3 line = (point(p1) - point(p0)) * (1.0 / best);
+      size_t p2 = p0;
+      best = 0.0;
+      for ( size_t i = 0; i < numOfPoints; i++ ) {
+        double d = length(cross(point(i) - point(p0), line));
+        if ( d > best ) {
+          best = d;
+          p2 = i;
+        }
+      }
+      if ( best <= eps ) {
+        return false;
+      }
+      Vec3 normal = cross(point(p1) - point(p0), point(p2) - point(p0));
+      normal = normal * (1.0 / length(normal));
+      size_t p3 = p0;
+      best = 0.0;
+      for ( size_t i = 0; i < numOfPoints; i++ ) {
+        double d = std::fabs(dot(point(i) - point(p0), normal));
+        if ( d > best ) {
+          best = d;
+          p3 = i;
+        }
+      }
+      if ( best <= eps ) {
+        return false;
+      }
+      //p3 below the p0 p1 p2 plane, so that face looks away from it
+      if ( dot(point(p3) - point(p0), normal) > 0.0 ) {
+        std::swap(p1, p2);
+      }
+
+      std::vector<Face> faces;
+      std::vector<uint32_t> next(numOfPoints, kNone);
+      auto addFace = [&](size_t a, size_t b, size_t c) {
+        Face face;
+        face.v[0] = static_cast<uint32_t>(a);
+        face.v[1] = static_cast<uint32_t>(b);
+        face.v[2] = static_cast<uint32_t>(c);
+        Vec3 n = cross(point(b) - point(a), point(c) - point(a));
+        face.normal = n * (1.0 / length(n));
+        face.offset = dot(face.normal, point(a));
+        face.outside = kNone;
+        face.alive = true;
+        faces.push_back(face);
+        return static_cast<uint32_t>(faces.size() - 1);
+      };
+      auto distance = [&](const Face& face, size_t i) {
+        return dot(face.normal, point(i)) - face.offset;
+      };
+      //puts point i on the first of faces [first, faces.size()) it is outside of
+      auto assign = [&](uint32_t i, size_t first) {
+        for ( size_t f = first; f < faces.size(); f++ ) {
+          if ( distance(faces[f], i) > eps ) {
+            next[i] = faces[f].outside;
+            faces[f].outside = i;
+            return;
+          }
+        }
+      };
+      auto link = [&](uint32_t f, uint32_t a, uint32_t b, uint32_t other) {
+        for ( int e = 0; e < 3; e++ ) {
+          if ( faces[f].v[e] == a && faces[f].v[(e + 1) % 3] == b ) {
+            faces[f].neighbor[e] = other;
+          }
+        }
+      };
+
+      addFace(p0, p1, p2);
+      addFace(p0, p3, p1);
+      addFace(p1, p3, p2);
+      addFace(p2, p3, p0);
+      for ( uint32_t f = 0; f < 4; f++ ) {
+        for ( int e = 0; e < 3; e++ ) {
+          uint32_t a = faces[f].v[e];
+          uint32_t b = faces[f].v[(e + 1) % 3];
+          for ( uint32_t g = 0; g < 4; g++ ) {
+            for ( int k = 0; k < 3; k++ ) {
+              if ( faces[g].v[k] == b && faces[g].v[(k + 1) % 3] == a ) {
+                faces[f].neighbor[e] = g;
+              }
+            }
+          }
+        }
+      }
+      for ( size_t i = 0; i < numOfPoints; i++ ) {
+        if ( i != p0 && i != p1 && i != p2 && i != p3 ) {
+          assign(static_cast<uint32_t>(i), 0);
+        }
+      }
+
+      struct Horizon {
+        uint32_t a, b, face;
+      };
+      std::vector<uint32_t> visible, stack, orphans;
+      std::vector<Horizon> horizon;
+      std::vector<uint32_t> marks;
+      uint32_t mark = 0;
+      for ( size_t f = 0; f < faces.size(); f++ ) {
+        if ( !faces[f].alive || faces[f].outside == kNone ) {
+          continue;
+        }
+        uint32_t apex = faces[f].outside;
+        for ( uint32_t i = next[apex]; i != kNone; i = next[i] ) {
+          if ( distance(faces[f], i) > distance(faces[f], apex) ) {
+            apex = i;
+          }
+        }
+
+        //faces apex sees, reached across neighbours
+        mark++;
+        marks.resize(faces.size(), 0);
+        visible.clear();
+        horizon.clear();
+        stack.assign(1, static_cast<uint32_t>(f));
+        marks[f] = mark;
+        while ( !stack.empty() ) {
+          uint32_t g = stack.back();
+          stack.pop_back();
+          visible.push_back(g);
+          for ( int e = 0; e < 3; e++ ) {
+            uint32_t h = faces[g].neighbor[e];
+            if ( marks[h] == mark ) {
+              continue;
+            }
+            if ( distance(faces[h], apex) > eps ) {
+              marks[h] = mark;
+              stack.push_back(h);
+            }
+            else {
+              horizon.push_back(Horizon{ faces[g].v[e], faces[g].v[(e + 1) % 3], h });
+            }
+          }
+        }
+
+        orphans.clear();
+        for ( uint32_t g : visible ) {
+          faces[g].alive = false;
+          for ( uint32_t i = faces[g].outside; i != kNone; i = next[i] ) {
+            if ( i != apex ) {
+              orphans.push_back(i);
+            }
+          }
+        }
+        size_t firstNew = faces.size();
+        for ( auto& edge : horizon ) {
+          uint32_t g = addFace(edge.a, edge.b, apex);
+          faces[g].neighbor[0] = edge.face;
+          link(edge.face, edge.b, edge.a, g);
+        }
+        //new faces meet along the edges to apex: b -> apex borders the face starting at b
+        for ( size_t g = firstNew; g < faces.size(); g++ ) {
+          for ( size_t h = firstNew; h < faces.size(); h++ ) {
+            if ( faces[h].v[0] == faces[g].v[1] ) {
+              faces[g].neighbor[1] = static_cast<uint32_t>(h);
+              faces[h].neighbor[2] = static_cast<uint32_t>(g);
+            }
+          }
+        }
+        for ( uint32_t i : orphans ) {
+          assign(i, firstNew);
+        }
+      }
+
+      for ( auto& face : faces ) {
+        if ( face.alive ) {
+          triangles.insert(triangles.end(), face.v, face.v + 3);
+        }
+      }
+      return true;
+    }
+  }
+
+  //! Ring
+  /*!
+  A beam end section around mCenter, mU & mV are its semi-axes (mU x mV
+  along the beam). Ellipses start on mU, rectangles at the mU + mV corner,
+  both turning towards mV.
+  */
+  struct LTCBeamMesher::Ring {
+    Vec3 mCenter;
+    Vec3 mU, mV;
+
+    Vec3 getPoint(uint32_t k, uint32_t size, bool rectangle)const {
+      if ( rectangle ) {
+        static const double signs[4][2] = { { 1.0, 1.0 }, { -1.0, 1.0 }, { -1.0, -1.0 }, { 1.0, -1.0 } };
+        return mCenter + mU * signs[k][0] + mV * signs[k][1];
+      }
+      double angle = 2.0 * kPi * k / size;
+      return mCenter + mU * std::cos(angle) + mV * std::sin(angle);
+    }
+  };
+
+  //! Section
+  /*!
+  An oriented beam end for RECTANGLE & ELLIPSE: mUp is the unit height
+  direction square to mAxis, the beam direction; mHeight & mThickness
+  are the semi-axes along mUp & mAxis x mUp.
+  */
+  struct LTCBeamMesher::Section {
+    Vec3 mCenter, mAxis, mUp;
+    double mHeight, mThickness;
+
+    //! The ring a fraction t of the way to end, turned by t * twist.
+    Ring interpolate(const Section& end, double t, double twist)const {
+      double angle = t * twist;
+      Vec3 up = mUp * std::cos(angle) + cross(mAxis, mUp) * std::sin(angle);
+      double height = mHeight + (end.mHeight - mHeight) * t;
+      double thickness = mThickness + (end.mThickness - mThickness) * t;
+      return Ring{ mCenter + (end.mCenter - mCenter) * t, up * height, cross(mAxis, up) * thickness };
+    }
+  };
+
+  //! Writer
+  /*!
+  Where a part goes; without buffers only the counts are kept.
+  */
+  struct LTCBeamMesher::Writer {
+    float* mVertices;
+    uint32_t* mTriangles;
+    uint32_t mFirstVertex;
+    size_t mNumOfVertices;
+    size_t mNumOfTriangles;
+
+    Writer(float* vertices, uint32_t* triangles, uint32_t firstVertex) :
+      mVertices(vertices),
+      mTriangles(triangles),
+      mFirstVertex(firstVertex),
+      mNumOfVertices(0),
+      mNumOfTriangles(0) {}
+
+    //! Adds a vertex, returns its index within the part.
+    uint32_t vertex(const Vec3& p) {
+      if ( mVertices ) {
+        float* out = mVertices + 3 * mNumOfVertices;
+        out[0] = static_cast<float>(p.x);
+        out[1] = static_cast<float>(p.y);
+        out[2] = static_cast<float>(p.z);
+      }
+      return static_cast<uint32_t>(mNumOfVertices++);
+    }
+
+    //! Adds a triangle of part vertex indices.
+    void triangle(uint32_t a, uint32_t b, uint32_t c) {
+      if ( mTriangles ) {
+        uint32_t* out = mTriangles + 3 * mNumOfTriangles;
+        out[0] = mFirstVertex + a;
+        out[1] = mFirstVertex + b;
+        out[2] = mFirstVertex + c;
+      }
+      mNumOfTriangles++;
+    }
+  };
+
+  std::shared_ptr<LTCBeamMesher> LTCBeamMesher::create(const LTCGraph& graph,
+                                                       const LTCMeshOptions& options) {
+    std::shared_ptr<LTCBeamMesher> mesher(new LTCBeamMesher(graph, options));
+    mesher->mOptions.mSegments = std::max(mesher->mOptions.mSegments, 3u);
+    unsigned int numOfThreads = resolveThreadCount(options.mNumOfThreads);
+    mesher->mAdjacency = graph.getAdjacency(numOfThreads);
+
+    //count every part by writing it without buffers
+    size_t numOfParts = graph.getBeams().size() + graph.getNodeCount();
+    mesher->mVertexOffsets.assign(numOfParts + 1, 0);
+    mesher->mTriangleOffsets.assign(numOfParts + 1, 0);
+    size_t numOfBlocks = (numOfParts + kBlockSize - 1) / kBlockSize;
+    parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+      size_t end = std::min((block + 1) * kBlockSize, numOfParts);
+      for ( size_t part = block * kBlockSize; part < end; part++ ) {
+        Writer counter(nullptr, nullptr, 0);
+        mesher->writePart(part, counter);
+        mesher->mVertexOffsets[part + 1] = counter.mNumOfVertices;
+        mesher->mTriangleOffsets[part + 1] = counter.mNumOfTriangles;
+      }
+    });
+    for ( size_t part = 0; part < numOfParts; part++ ) {
+      mesher->mVertexOffsets[part + 1] += mesher->mVertexOffsets[part];
+      mesher->mTriangleOffsets[part + 1] += mesher->mTriangleOffsets[part];
+    }
+    return mesher;
+  }
+
+  bool LTCBeamMesher::mesh(LTCMesh& mesh)const {
+    return this->mesh(0, getPartCount(), mesh);
+  }
+
+  bool LTCBeamMesher::mesh(size_t firstPart, size_t lastPart, LTCMesh& mesh)const {
+    if ( getVertexCount(firstPart, lastPart) > std::numeric_limits<uint32_t>::max() ) {
+      mesh.clear();
+      return false;
+    }
+    //every value gets written, reuse the buffers as they are
+    mesh.mVertices.resize(3 * getVertexCount(firstPart, lastPart));
+    mesh.mTriangles.resize(3 * getTriangleCount(firstPart, lastPart));
+    size_t firstVertex = mVertexOffsets[firstPart];
+    size_t firstTriangle = mTriangleOffsets[firstPart];
+    size_t numOfParts = lastPart - firstPart;
+    size_t numOfBlocks = (numOfParts + kBlockSize - 1) / kBlockSize;
+    parallelFor(numOfBlocks, mOptions.mNumOfThreads, [&](size_t block) {
+      size_t end = firstPart + std::min((block + 1) * kBlockSize, numOfParts);
+      for ( size_t part = firstPart + block * kBlockSize; part < end; part++ ) {
+        size_t vertex = mVertexOffsets[part] - firstVertex;
+        Writer writer(mesh.mVertices.data() + 3 * vertex,
+                      mesh.mTriangles.data() + 3 * (mTriangleOffsets[part] - firstTriangle),
+                      static_cast<uint32_t>(vertex));
+        writePart(part, writer);
+      }
+    });
+    return true;
+  }
+
+  double LTCBeamMesher::getRadius(const Node& node)const {
+    return node.mRadius > 0.0 ? node.mRadius : std::max(mOptions.mDefaultRadius, 0.0);
+  }
+
+  bool LTCBeamMesher::isValid(size_t beam)const {
+    auto& b = mGraph.getBeams()[beam];
+    size_t numOfNodes = mGraph.getNodeCount();
+    if ( b.mNode1Idx < 0 || b.mNode2Idx < 0 ||
+         static_cast<size_t>(b.mNode1Idx) >= numOfNodes ||
+         static_cast<size_t>(b.mNode2Idx) >= numOfNodes ) {
+      return false;
+    }
+    Node a = mGraph.getNode(b.mNode1Idx);
+    Node c = mGraph.getNode(b.mNode2Idx);
+    return length(position(c) - position(a)) > 0.0 &&
+      std::max(getRadius(a), getRadius(c)) > 0.0;
+  }
+
+  size_t LTCBeamMesher::getDegree(size_t node)const {
+    size_t degree = 0;
+    for ( int beam : mAdjacency->getBeamIndices(node) ) {
+      degree += isValid(beam) ? 1 : 0;
+    }
+    return degree;
+  }
+
+  bool LTCBeamMesher::getRings(size_t beam, Ring& start, Ring& end)const {
+    if ( !isValid(beam) ) {
+      return false;
+    }
+    auto& b = mGraph.getBeams()[beam];
+    Node n1 = mGraph.getNode(b.mNode1Idx);
+    Node n2 = mGraph.getNode(b.mNode2Idx);
+    if ( mOptions.mSection != LTCSection::ROUND ) {
+      Section sections[2];
+      double twist;
+      getSections(n1, n2, sections[0], sections[1], twist);
+      start = sections[0].interpolate(sections[1], 0.0, twist);
+      end = sections[0].interpolate(sections[1], 1.0, twist);
+      return true;
+    }
+    Vec3 a = position(n1);
+    Vec3 axis = position(n2) - a;
+    double len = length(axis);
+    axis = axis * (1.0 / len);
+    double ra = getRadius(n1);
+    double rb = getRadius(n2);
+    double ta = 0.0;
+    double tb = len;
+
+    if ( mOptions.mJoints == LTCJointType::SPHERE ) {
+      //circles where the cone touches both spheres; nothing shows when
+      //one sphere swallows the other
+      double s = (ra - rb) / len;
+      if ( std::fabs(s) >= 1.0 ) {
+        return false;
+      }
+      double c = std::sqrt(1.0 - s * s);
+      ta = ra * s;
+      tb = len + rb * s;
+      ra *= c;
+      rb *= c;
+    }
+    else if ( mOptions.mJoints == LTCJointType::HULL ) {
+      //cut back by the node radius where there is a hull, at most a third each
+      if ( getDegree(b.mNode1Idx) >= 2 ) {
+        ta = std::min(ra, len / 3.0);
+      }
+      if ( getDegree(b.mNode2Idx) >= 2 ) {
+        tb = len - std::min(rb, len / 3.0);
+      }
+      double r1 = ra;
+      double r2 = rb;
+      ra = r1 + (r2 - r1) * ta / len;
+      rb = r1 + (r2 - r1) * tb / len;
+    }
+
+    Vec3 u, v;
+    getFrame(axis, u, v);
+    start = Ring{ a + axis * ta, u * ra, v * ra };
+    end = Ring{ a + axis * tb, u * rb, v * rb };
+    return true;
+  }
+
+  void LTCBeamMesher::getSections(const Node& n1, const Node& n2,
+                                  Section& start, Section& end, double& twist)const {
+    Vec3 axis = position(n2) - position(n1);
+    axis = axis * (1.0 / length(axis));
+    Vec3 u, v;
+    getFrame(axis, u, v);
+    const Node* nodes[2] = { &n1, &n2 };
+    Section* sections[2] = { &start, &end };
+    for ( int i = 0; i < 2; i++ ) {
+      const Node& node = *nodes[i];
+      double thickness = getRadius(node);
+      //orientation square to the beam, the frame's if there is none
+      Vec3 orientation{ node.mXE - node.mXS, node.mYE - node.mYS, node.mZE - node.mZS };
+      Vec3 up = orientation - axis * dot(orientation, axis);
+      double upLength = length(up);
+      double height;
+      if ( upLength > 1e-9 * length(orientation) ) {
+        up = up * (1.0 / upLength);
+        height = 0.5 * upLength;
+      }
+      else {
+        up = i == 0 ? u : start.mUp;
+        height = thickness;
+      }
+      //sections are symmetric, turn the end one the short way round
+      if ( i == 1 && dot(up, start.mUp) < 0.0 ) {
+        up = up * -1.0;
+      }
+      Section& section = *sections[i];
+      section.mCenter = position(node);
+      section.mAxis = axis;
+      section.mUp = up;
+      section.mHeight = height;
+      section.mThickness = thickness;
+    }
+    twist = std::atan2(dot(cross(start.mUp, end.mUp), axis), dot(start.mUp, end.mUp));
+  }
+
+  uint32_t LTCBeamMesher::getSliceCount(double twist)const {
+    double step = kPi / mOptions.mSegments;
+    return std::max(1u, static_cast<uint32_t>(std::ceil(std::fabs(twist) / step - 1e-9)));
+  }
+
+  uint32_t LTCBeamMesher::getRingSize()const {
+    return mOptions.mSection == LTCSection::RECTANGLE ? 4 : mOptions.mSegments;
+  }
+
+  void LTCBeamMesher::writePart(size_t part, Writer& writer)const {
+    size_t numOfBeams = mGraph.getBeams().size();
+    if ( part < numOfBeams ) {
+      writeBeam(part, writer);
+    }
+    else {
+      writeJoint(part - numOfBeams, writer);
+    }
+  }
+
+  void LTCBeamMesher::writeBeam(size_t beam, Writer& writer)const {
+    //round beams are one slice between their end rings, oriented ones
+    //are cut into slices so the twist is spread along the beam
+    Ring rings[2];
+    Section sections[2];
+    double twist = 0.0;
+    uint32_t slices = 1;
+    bool round = mOptions.mSection == LTCSection::ROUND;
+    if ( round ) {
+      if ( !getRings(beam, rings[0], rings[1]) ) {
+        return;
+      }
+    }
+    else {
+      if ( !isValid(beam) ) {
+        return;
+      }
+      auto& b = mGraph.getBeams()[beam];
+      getSections(mGraph.getNode(b.mNode1Idx), mGraph.getNode(b.mNode2Idx),
+                  sections[0], sections[1], twist);
+      slices = getSliceCount(twist);
+    }
+    auto getRing = [&](uint32_t slice) {
+      return round ? rings[slice] :
+        sections[0].interpolate(sections[1], static_cast<double>(slice) / slices, twist);
+    };
+
+    //ring vertices slice by slice, then the two cap centres
+    uint32_t segments = getRingSize();
+    bool rectangle = mOptions.mSection == LTCSection::RECTANGLE;
+    for ( uint32_t slice = 0; slice <= slices; slice++ ) {
+      Ring ring = getRing(slice);
+      for ( uint32_t k = 0; k < segments; k++ ) {
+        writer.vertex(ring.getPoint(k, segments, rectangle));
+      }
+    }
+    uint32_t startCap = writer.vertex(getRing(0).mCenter);
+    uint32_t endCap = writer.vertex(getRing(slices).mCenter);
+    uint32_t last = slices * segments;
+    for ( uint32_t k = 0; k < segments; k++ ) {
+      uint32_t next = (k + 1) % segments;
+      writer.triangle(startCap, next, k);
+      writer.triangle(endCap, last + k, last + next);
+    }
+
+    //side walls: oriented sections twist, so their wall quads aren't flat
+    //& splitting one along a diagonal cuts in or bulges out; a fan around
+    //the quad's center encloses the same volume as the ruled surface
+    for ( uint32_t slice = 0; slice < slices; slice++ ) {
+      uint32_t base = slice * segments;
+      Ring bottom = getRing(slice), top = getRing(slice + 1);
+      for ( uint32_t k = 0; k < segments; k++ ) {
+        uint32_t next = (k + 1) % segments;
+        if ( round ) {
+          writer.triangle(base + k, base + next, base + segments + k);
+          writer.triangle(base + next, base + segments + next, base + segments + k);
+          continue;
+        }
+        Vec3 center = (bottom.getPoint(k, segments, rectangle) + bottom.getPoint(next, segments, rectangle) +
+                      top.getPoint(k, segments, rectangle) + top.getPoint(next, segments, rectangle)) * 0.25;
+        uint32_t c = writer.vertex(center);
+        writer.triangle(c, base + k, base + next);
+        writer.triangle(c, base + next, base + segments + next);
+        writer.triangle(c, base + segments + next, base + segments + k);
+        writer.triangle(c, base + segments + k, base + k);
+      }
+    }
+  }
+
+  void LTCBeamMesher::getJointPoints(size_t node, std::vector<double>& points)const {
+    points.clear();
+    uint32_t segments = mOptions.mSegments;
+    for ( int beam : mAdjacency->getBeamIndices(node) ) {
+      Ring rings[2];
+      if ( !getRings(beam, rings[0], rings[1]) ) {
+        continue;
+      }
+      auto& ring = mGraph.getBeams()[beam].mNode1Idx == static_cast<int>(node) ? rings[0] : rings[1];
+      for ( uint32_t k = 0; k < segments; k++ ) {
+        Vec3 p = ring.getPoint(k, segments, false);
+        points.push_back(p.x);
+        points.push_back(p.y);
+        points.push_back(p.z);
+      }
+    }
+  }
+
+  void LTCBeamMesher::writeJoint(size_t node, Writer& writer)const {
+    if ( mOptions.mJoints == LTCJointType::NONE || mOptions.mSection != LTCSection::ROUND ) {
+      return;
+    }
+    size_t degree = getDegree(node);
+    Node n = mGraph.getNode(node);
+    double radius = getRadius(n);
+    double center[3] = { n.mX, n.mY, n.mZ };
+    if ( degree == 0 || !(radius > 0.0) ) {
+      return;
+    }
+    if ( mOptions.mJoints == LTCJointType::SPHERE || degree == 1 ) {
+      writeSphere(center, radius, writer);
+      return;
+    }
+
+    std::vector<double> points;
+    std::vector<uint32_t> triangles;
+    getJointPoints(node, points);
+    if ( !getConvexHull(points, triangles) ) {
+      //beam ends all in one plane, cover the cut back ends instead
+      writeSphere(center, radius * std::sqrt(2.0), writer);
+      return;
+    }
+    //only the points on the hull become vertices
+    std::vector<uint32_t> map(points.size() / 3, UINT32_MAX);
+    for ( uint32_t& idx : triangles ) {
+      if ( map[idx] == UINT32_MAX ) {
+        map[idx] = writer.vertex(Vec3{ points[3 * idx], points[3 * idx + 1], points[3 * idx + 2] });
+      }
+      idx = map[idx];
+    }
+    for ( size_t t = 0; t < triangles.size(); t += 3 ) {
+      writer.triangle(triangles[t], triangles[t + 1], triangles[t + 2]);
+    }
+  }
+
+  void LTCBeamMesher::writeSphere(const double center[3], double radius, Writer& writer)const {
+    //latitude bands between the poles, vertices: pole, rings, pole
+    uint32_t segments = mOptions.mSegments;
+    uint32_t bands = std::max(segments / 2, 2u);
+    Vec3 c{ center[0], center[1], center[2] };
+    uint32_t north = writer.vertex(c + Vec3{ 0.0, 0.0, radius });
+    for ( uint32_t i = 1; i < bands; i++ ) {
+      double polar = kPi * i / bands;
+      for ( uint32_t k = 0; k < segments; k++ ) {
+        double angle = 2.0 * kPi * k / segments;
+        writer.vertex(c + Vec3{ std::sin(polar) * std::cos(angle),
+                                std::sin(polar) * std::sin(angle),
+                                std::cos(polar) } * radius);
+      }
+    }
+    uint32_t south = writer.vertex(c - Vec3{ 0.0, 0.0, radius });
+    auto ring = [&](uint32_t band, uint32_t k) {
+      return north + 1 + (band - 1) * segments + k % segments;
+    };
+    for ( uint32_t k = 0; k < segments; k++ ) {
+      writer.triangle(north, ring(1, k), ring(1, k + 1));
+      for ( uint32_t i = 1; i + 1 < bands; i++ ) {
+        writer.triangle(ring(i, k), ring(i + 1, k), ring(i + 1, k + 1));
+        writer.triangle(ring(i, k), ring(i + 1, k + 1), ring(i, k + 1));
+      }
+      writer.triangle(south, ring(bands - 1, k + 1), ring(bands - 1, k));
+    }
+  }
+
+}//namespace LTC
@@ -0,0 +1,179 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace LTC {
+
+  class LTCAdjacency;
+
+  //! LTCMesh
+  /*!
+  Indexed triangle mesh in mm. Triangles are counter-clockwise seen from
+  outside.
+  */
+  struct LTCMesh {
+    std::vector<float> mVertices;      //x, y, z per vertex
+    std::vector<uint32_t> mTriangles;  //3 vertex indices per triangle
+
+    size_t getVertexCount()const { return mVertices.size() / 3; }
+    size_t getTriangleCount()const { return mTriangles.size() / 3; }
+    void clear() { *this = LTCMesh(); }
+  };
+
+  //! LTCJointType
+  /*!
+  What LTCBeamMesher puts at the nodes.
+  */
+  enum class LTCJointType {
+    NONE = 0,    //nothing, beams end in flat caps at the node centres
+    SPHERE = 1,  //a sphere of the node radius, beams run tangent to the spheres
+    HULL = 2     //convex hull of the beam ends, beams are cut back by the node radius
+  };
+
+  //! LTCSection
+  /*!
+  Beam cross-section for LTCBeamMesher. RECTANGLE & ELLIPSE are for rib
+  graphs: at every node the section's height runs along the node's
+  orientation E - S (from mXS.. to mXE..) projected square to the beam &
+  is as long as that projection; it is twice the node radius thick.
+  */
+  enum class LTCSection {
+    ROUND = 0,
+    RECTANGLE = 1,
+    ELLIPSE = 2
+  };
+
+  //! LTCMeshOptions
+  struct LTCMeshOptions {
+    unsigned int mSegments;      //around each beam, ellipse & sphere, at least 3
+    LTCJointType mJoints;        //ROUND sections only
+    LTCSection mSection;
+    double mDefaultRadius;       //for nodes without a radius, in mm
+    unsigned int mNumOfThreads;  //0 = hardware threads
+
+    LTCMeshOptions() :
+      mSegments(16),
+      mJoints(LTCJointType::SPHERE),
+      mSection(LTCSection::ROUND),
+      mDefaultRadius(0.0),
+      mNumOfThreads(0) {}
+  };
+
+  //! LTCBeamMesher
+  /*!
+  Turns a round graph into triangles: a tapered cylinder per beam (the
+  radius runs linearly from one node's radius to the other's) & a joint
+  per node with beams. Every beam & joint is a closed, consistently
+  oriented shell of its own, so the output is a set of closed shells that
+  overlap where they meet, not a single manifold: no boolean union is
+  done. Slicers that fill by winding number print it as is; tools that
+  need one manifold surface have to union the shells.
+
+  create() works out how many vertices & triangles every part (beams
+  first, then the joints in node order) takes, so mesh() fills buffers of
+  the final size in parallel without locking & gives the same mesh on
+  any thread count. A range of parts can be meshed on its own to keep
+  memory bounded.
+
+  Rib graphs are swept instead with LTCSection::RECTANGLE or ELLIPSE: the
+  section at each end of a beam is turned to the node's orientation,
+  projected square to the beam. Between the ends the section turns about
+  the beam at a steady rate, the short way round, while its size changes
+  linearly; twisting beams are cut into slices of at most pi / mSegments
+  of turn each, so the section keeps its size rather than pinching in the
+  middle. Beams end in flat caps at the node centres; nodes without
+  orientation get a section square to the beam, as tall as it is thick.
+
+  Beams with a node out of range, no length or no radius are skipped. The
+  graph must outlive the mesher & stay unchanged.
+  */
+  class LTCBeamMesher {
+  public:
+    static std::shared_ptr<LTCBeamMesher> create(const LTCGraph& graph,
+                                                 const LTCMeshOptions& options = LTCMeshOptions());
+
+    //! Beams & nodes, parts [0, beams) are beams, the rest the joints.
+    size_t getPartCount()const { return mVertexOffsets.size() - 1; }
+    size_t getVertexCount()const { return mVertexOffsets.back(); }
+    size_t getTriangleCount()const { return mTriangleOffsets.back(); }
+    size_t getVertexCount(size_t firstPart, size_t lastPart)const {
+      return mVertexOffsets[lastPart] - mVertexOffsets[firstPart];
+    }
+    size_t getTriangleCount(size_t firstPart, size_t lastPart)const {
+      return mTriangleOffsets[lastPart] - mTriangleOffsets[firstPart];
+    }
+
+    //! Meshes every part, false if there are more vertices than 32 bit indices reach.
+    bool mesh(LTCMesh& mesh)const;
+    //! Meshes parts [firstPart, lastPart) into mesh, indices start at 0; mesh keeps its capacity.
+    bool mesh(size_t firstPart, size_t lastPart, LTCMesh& mesh)const;
+
+  private:
+    LTCBeamMesher(const LTCGraph& graph, const LTCMeshOptions& options) :
+      mGraph(graph),
+      mOptions(options) {}
+
+    struct Writer;
+    struct Ring;
+    struct Section;
+
+    double getRadius(const Node& node)const;
+    bool isValid(size_t beam)const;
+    //! Beams at node that get meshed.
+    size_t getDegree(size_t node)const;
+    //! The end sections of a beam, false if it isn't meshed.
+    bool getRings(size_t beam, Ring& start, Ring& end)const;
+    //! Oriented end sections for RECTANGLE & ELLIPSE, twist is the turn from start to end about the beam.
+    void getSections(const Node& n1, const Node& n2, Section& start, Section& end, double& twist)const;
+    //! Slices a beam twisting by twist is swept in.
+    uint32_t getSliceCount(double twist)const;
+    //! Vertices around a section.
+    uint32_t getRingSize()const;
+    //! The beam end points around node, for a hull joint.
+    void getJointPoints(size_t node, std::vector<double>& points)const;
+
+    //! Writes part, or only counts it if writer has no buffers.
+    void writePart(size_t part, Writer& writer)const;
+    void writeBeam(size_t beam, Writer& writer)const;
+    void writeJoint(size_t node, Writer& writer)const;
+    void writeSphere(const double center[3], double radius, Writer& writer)const;
+
+    const LTCGraph& mGraph;
+    LTCMeshOptions mOptions;
+    std::shared_ptr<const LTCAdjacency> mAdjacency;
+    std::vector<size_t> mVertexOffsets;    //first vertex of every part
+    std::vector<size_t> mTriangleOffsets;  //first triangle of every part
+  };
+
+}//namespace LTC
@@ -25,8 +25,21 @@
 //
 
 #include "LTCModel.h"
+#include "LTC3MF.h"
+#include "LTCBinary.h"
+#include "LTCFile.h"
+#include "LTCGraphHandle.h"
+#include "LTCGraphIndex.h"
+#include "LTCGraphView.h"
+#include "LTCMeshWriter.h"
+#include "LTCNumber.h"
+#include "LTCParallelReader.h"
+#include "LTCStreamReader.h"
+#include "LTCStreamWriter.h"
 #include <tinyxml2.h>
 
+#include <cstring>
+
 using namespace tinyxml2;
 
 namespace LTC {
@@ -50,7 +63,7 @@ namespace LTC {
       if ( name == nullptr ) {
         name = "no_name";
       }
-      LTCUnits gUnits;
+      LTCUnits gUnits = LTCUnits::MM;
       auto unitsRead = graphX->Attribute("units");
       if ( unitsRead == nullptr ) {
         gUnits = LTCUnits::MM;
@@ -74,7 +87,12 @@ namespace LTC {
           gUnits = LTCUnits::FT;
         }
       }
-      auto graph = LTCGraph::create(name, id, gUnits);
+      //raw nodes, converted in one pass below (see LTCStreamReader::readGraph)
+      bool convertAfterRead = gUnits != LTCUnits::MM &&
+        mNodePrecision == LTCNodePrecision::FLOAT64;
+      auto graph = LTCGraph::create(name, id, convertAfterRead ? LTCUnits::MM : gUnits);
+      graph->setNodeStorage(mNodeStorage);
+      graph->setNodePrecision(mNodePrecision);
 
       auto nodes = graphX->FirstChildElement("nodegroup");
       if ( !nodes ) {
@@ -89,34 +107,35 @@ namespace LTC {
         return LTC_ERROR::LTC_NO_NODES;
       }
 
-      double xVal, yVal, zVal, rad;
-      double xS, yS, zS, xE, yE, zE;
-      bool isOriented = false;
+      // x y z r xs ys zs xe ye ze
+      double v[10];
       do {
-        rad = -1.0;
-        xS = yS = zS = xE = yE = zE = -1;
-        currentNode->QueryDoubleAttribute("x", &xVal);
-        currentNode->QueryDoubleAttribute("y", &yVal);
-        currentNode->QueryDoubleAttribute("z", &zVal);
-        currentNode->QueryDoubleAttribute("r", &rad);
-
-        currentNode->QueryDoubleAttribute("xs", &xS);
-        currentNode->QueryDoubleAttribute("ys", &yS);
-        currentNode->QueryDoubleAttribute("zs", &zS);
-        currentNode->QueryDoubleAttribute("xe", &xE);
-        currentNode->QueryDoubleAttribute("ye", &yE);
-        currentNode->QueryDoubleAttribute("ze", &zE);
-        if ( xS != xE ||
-            yS != yE ||
-            zS != zE ) {
-          graph->addNode(xVal, yVal, zVal, rad, xS, yS, zS, xE, yE, zE);
-          isOriented = true;
+        v[3] = -1.0;
+        v[4] = v[5] = v[6] = v[7] = v[8] = v[9] = -1;
+
+        //one pass over the attributes, numbers go through the fast parser
+        for ( auto attribute = currentNode->FirstAttribute(); attribute; attribute = attribute->Next() ) {
+          auto attributeName = attribute->Name();
+          int slot = LTCStreamReader::nodeAttributeSlot(attributeName, strlen(attributeName));
+          if ( slot >= 0 ) {
+            auto value = attribute->Value();
+            parseDouble(value, value + strlen(value), v[slot]);
+          }
+        }
+        if ( v[4] != v[7] ||
+            v[5] != v[8] ||
+            v[6] != v[9] ) {
+          graph->addNode(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9]);
         }
         else {
-          graph->addNode(xVal, yVal, zVal, rad);
+          graph->addNode(v[0], v[1], v[2], v[3]);
         }
         currentNode = currentNode->NextSiblingElement("node");
       } while ( currentNode );
+      if ( convertAfterRead ) {
+        graph->setUnits(gUnits);
+        graph->scaleNodes(LTCGraph::getUnitScale(gUnits));
+      }
 
 
       //read in beams:
@@ -191,6 +210,24 @@ namespace LTC {
     return readFromXml(doc);
   }
 
+  LTC_ERROR LTCModel::readFromTextStreaming(const char* text, size_t numOfBytes) {
+    LTCXmlScanner scanner(text, numOfBytes);
+    LTCStreamReader reader(scanner, mNodeStorage, mNodePrecision);
+    return reader.read(mGraphs);
+  }
+
+  LTC_ERROR LTCModel::readFromFileStreaming(const char* path) {
+    auto file = openFile(path, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    LTCXmlScanner scanner(file);
+    LTCStreamReader reader(scanner, mNodeStorage, mNodePrecision);
+    auto err = reader.read(mGraphs);
+    fclose(file);
+    return err;
+  }
+
   LTC::LTC_ERROR LTCModel::writeToFile(const char* path,
                                        const std::string& comment) {
     //Make new XML Doc
@@ -205,6 +242,47 @@ namespace LTC {
     return static_cast<LTC_ERROR>(err);
   }
 
+  LTC_ERROR LTCModel::readFromTextParallel(const char* text, size_t numOfBytes,
+                                           unsigned int numOfThreads) {
+    LTCParallelReader reader(numOfThreads, mNodeStorage, mNodePrecision);
+    return reader.read(text, numOfBytes, mGraphs);
+  }
+
+  LTC_ERROR LTCModel::readFromFileParallel(const char* path, unsigned int numOfThreads) {
+    LTC_ERROR err;
+    auto file = LTCMappedFile::open(path, err);
+    if ( !file ) {
+      //empty files can't be mapped, let the streaming reader report them
+      return err == LTC_ERROR::LTC_INVALID_BINARY ? readFromFileStreaming(path) : err;
+    }
+    return readFromTextParallel(reinterpret_cast<const char*>(file->data()),
+                                static_cast<size_t>(file->size()), numOfThreads);
+  }
+
+  LTC_ERROR LTCModel::writeToFileStreaming(const char* path,
+                                           const std::string& comment,
+                                           const LTCWriteOptions& options) {
+    return writeToFileParallel(path, comment, 1, options);
+  }
+
+  LTC_ERROR LTCModel::writeToFileParallel(const char* path,
+                                          const std::string& comment,
+                                          unsigned int numOfThreads,
+                                          const LTCWriteOptions& options) {
+    //text mode like XMLDocument::SaveFile, so line endings match too
+    auto file = openFile(path, "w");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+    LTCStreamWriter writer(file, options);
+    writer.setNumOfThreads(numOfThreads);
+    auto err = writer.write(mGraphs, comment);
+    if ( fclose(file) != 0 && err == LTC_ERROR::OK ) {
+      err = LTC_ERROR::LTC_FILE_WRITE_ERROR;
+    }
+    return err;
+  }
+
   LTC_ERROR LTCModel::writeToXml(tinyxml2::XMLDocument* doc,
                                  const std::string&     comment) {
 
@@ -323,50 +401,220 @@ namespace LTC {
     return LTC_ERROR::OK;
   }
 
+  LTC_ERROR LTCModel::readFromBinary(const char* path) {
+    size_t first = mGraphs.size();
+    auto err = LTCBinary::read(path, mGraphs);
+    for ( size_t i = first; i < mGraphs.size(); i++ ) {
+      //FLOAT32 implies SoA, don't round trip float graphs through AoS
+      if ( mNodePrecision != LTCNodePrecision::FLOAT32 ) {
+        mGraphs[i]->setNodeStorage(mNodeStorage);
+      }
+      mGraphs[i]->setNodePrecision(mNodePrecision);
+    }
+    return err;
+  }
+
+  LTC_ERROR LTCModel::writeToBinary(const char* path) {
+    return LTCBinary::write(path, mGraphs);
+  }
+
+  LTC_ERROR LTCModel::readFrom3MF(const char* path) {
+    size_t first = mGraphs.size();
+    auto err = LTC3MF::read(path, mGraphs);
+    for ( size_t i = first; i < mGraphs.size(); i++ ) {
+      mGraphs[i]->setNodeStorage(mNodeStorage);
+      mGraphs[i]->setNodePrecision(mNodePrecision);
+    }
+    return err;
+  }
+
+  LTC_ERROR LTCModel::writeTo3MF(const char* path, double defaultRadius) {
+    return LTC3MF::write(path, mGraphs, defaultRadius);
+  }
+
+  LTC_ERROR LTCModel::writeMeshToFile(const char* path,
+                                      LTCMeshFormat format,
+                                      const LTCMeshOptions& options) {
+    auto file = openFile(path, "wb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_COULD_NOT_BE_OPENED;
+    }
+    LTCMeshWriter writer(file, format, options);
+    auto err = writer.write(mGraphs);
+    if ( fclose(file) != 0 && err == LTC_ERROR::OK ) {
+      err = LTC_ERROR::LTC_FILE_WRITE_ERROR;
+    }
+    return err;
+  }
+
   LTC_ERROR LTCModel::getTypes(const char* path,
                                std::vector<GRAPH_TYPE>& types) {
-    XMLError err;
-    XMLDocument doc;
-    doc.LoadFile(path);
-    err = doc.ErrorID();
-    if ( err != 0 ) {
-      return static_cast<LTC_ERROR>(doc.ErrorID());
+    //only the graph start tags matter, no need to load the document
+    std::vector<LTCGraphInfo> infos;
+    auto err = scanFile(path, infos);
+    for ( auto& info : infos ) {
+      types.push_back(info.mType);
     }
+    return err;
+  }
 
-    //Get first lattice
-    auto graphX = doc.FirstChildElement("graph");
-    if ( !graphX ) {
-      return LTC_ERROR::LTC_NO_LATTICE;
+  LTC_ERROR LTCModel::readGraph(const char* path, int id) {
+    return readGraph(path, &id, nullptr);
+  }
+
+  LTC_ERROR LTCModel::readGraph(const char* path, const std::string& name) {
+    return readGraph(path, nullptr, &name);
+  }
+
+  LTC_ERROR LTCModel::writeGraphIndex(const char* path) {
+    LTCGraphIndex index;
+    auto err = LTCGraphIndex::build(path, index);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
     }
-    do {
-      int id;
-      err = graphX->QueryIntAttribute("id", &id); //get lattice id
-      if ( err != 0 ) {
-        return static_cast<LTC_ERROR>(err);
-      }
-      auto name = graphX->Attribute("name"); //get lattice name
-      if ( name == nullptr ) {
-        name = "no_name";
-      }
-      auto type = graphX->Attribute("type"); //get lattice type
-      if ( type == nullptr ) {
-        types.push_back(ROUND);
+    return index.save(LTCGraphIndex::sidecarPath(path).c_str());
+  }
+
+  LTC_ERROR LTCModel::readGraph(const char* path, const int* id, const std::string* name) {
+    auto file = openFile(path, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    char magic[sizeof(kBinaryMagic)];
+    bool isBinary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+      memcmp(magic, kBinaryMagic, sizeof(magic)) == 0;
+    auto err = isBinary ? readBinaryGraph(file, id, name)
+                        : readIndexedGraph(file, path, id, name);
+    fclose(file);
+    return err;
+  }
+
+  LTC_ERROR LTCModel::readBinaryGraph(FILE* file, const int* id, const std::string* name) {
+    LTCBinaryHeader header;
+    std::vector<LTCBinaryGraphEntry> entries;
+    auto err = LTCBinary::readTableOfContents(file, header, entries);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+    for ( auto& entry : entries ) {
+      if ( id ) {
+        if ( entry.mID != *id ) {
+          continue;
+        }
       }
       else {
-        std::string sType = std::string(type);
-        if ( sType == "rnd" ) {
-          types.push_back(ROUND);
+        std::string entryName;
+        err = LTCBinary::readName(file, entry, entryName);
+        if ( err != LTC_ERROR::OK ) {
+          return err;
         }
-        else if ( sType == "rib" ) {
-          types.push_back(RIB);
+        if ( entryName != *name ) {
+          continue;
         }
-        else {
-          types.push_back(UNDEFINED);
+      }
+      LTCGraphP graph;
+      err = LTCBinary::readGraph(file, entry, graph);
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+      //same as readFromBinary
+      if ( mNodePrecision != LTCNodePrecision::FLOAT32 ) {
+        graph->setNodeStorage(mNodeStorage);
+      }
+      graph->setNodePrecision(mNodePrecision);
+      mGraphs.push_back(graph);
+      return LTC_ERROR::OK;
+    }
+    return LTC_ERROR::LTC_NO_LATTICE;
+  }
+
+  LTC_ERROR LTCModel::readIndexedGraph(FILE* file, const char* path,
+                                       const int* id, const std::string* name) {
+    LTCGraphIndex index;
+    bool fromSidecar;
+    auto err = LTCGraphIndex::open(path, index, &fromSidecar);
+    if ( err != LTC_ERROR::OK ) {
+      return err;
+    }
+    while ( true ) {
+      auto entry = id ? index.find(*id) : index.find(*name);
+      if ( !entry ) {
+        if ( fromSidecar ) {
+          fromSidecar = false;
+          err = LTCGraphIndex::build(path, index);
+          if ( err != LTC_ERROR::OK ) {
+            return err;
+          }
+          continue;
         }
+        return LTC_ERROR::LTC_NO_LATTICE;
       }
-      graphX = graphX->NextSiblingElement("graph");
-    } while ( graphX );
-    return LTC_ERROR::OK;
+
+      LTCGraphP graph;
+      err = LTCGraphIndex::readGraph(file, *entry, mNodeStorage, mNodePrecision, graph);
+
+      //the file may have changed without changing size, check what was read
+      bool matches = err == LTC_ERROR::OK && graph &&
+        (id ? graph->getID() == *id : graph->getName() == *name);
+      if ( !matches && fromSidecar ) {
+        fromSidecar = false;
+        err = LTCGraphIndex::build(path, index);
+        if ( err != LTC_ERROR::OK ) {
+          return err;
+        }
+        continue;
+      }
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+      if ( !graph ) {
+        //neither beams nor faces, the readers skip these graphs
+        return LTC_ERROR::LTC_NO_BEAMS;
+      }
+      mGraphs.push_back(graph);
+      return LTC_ERROR::OK;
+    }
+  }
+
+  LTC_ERROR LTCModel::readLazy(const char* path) {
+    return LTCGraphHandle::open(path, mGraphHandles, mNodeStorage, mNodePrecision);
+  }
+
+  LTC_ERROR LTCModel::loadGraphs() {
+    //stop at the first error, the handles from there on stay lazy
+    size_t numLoaded = 0;
+    auto err = LTC_ERROR::OK;
+    for ( ; numLoaded < mGraphHandles.size(); numLoaded++ ) {
+      LTCGraphP graph;
+      err = mGraphHandles[numLoaded]->getGraph(graph);
+      if ( err != LTC_ERROR::OK ) {
+        break;
+      }
+      if ( graph ) {
+        mGraphs.push_back(graph);
+      }
+    }
+    mGraphHandles.erase(mGraphHandles.begin(), mGraphHandles.begin() + numLoaded);
+    return err;
+  }
+
+  LTC_ERROR LTCModel::scanText(const char* text, size_t numOfBytes,
+                               std::vector<LTCGraphInfo>& infos) {
+    LTCXmlScanner scanner(text, numOfBytes);
+    LTCStreamReader reader(scanner);
+    return reader.scan(infos);
+  }
+
+  LTC_ERROR LTCModel::scanFile(const char* path, std::vector<LTCGraphInfo>& infos) {
+    auto file = openFile(path, "rb");
+    if ( !file ) {
+      return LTC_ERROR::XML_ERROR_FILE_NOT_FOUND;
+    }
+    LTCXmlScanner scanner(file);
+    LTCStreamReader reader(scanner);
+    auto err = reader.scan(infos);
+    fclose(file);
+    return err;
   }
 
   LTC::LTC_ERROR LTCModel::addGeometry(const std::vector<Node>& nodes,
@@ -398,4 +646,28 @@ namespace LTC {
     return LTC_ERROR::OK;
   }
 
+  LTC::LTC_ERROR LTCModel::addGeometry(std::vector<Node>&& nodes,
+                                       std::vector<Beam>&& beams,
+                                       const std::string& name) {
+    auto graph = LTCGraph::create((int)mGraphs.size());
+    graph->setNodes(std::move(nodes));
+    graph->setBeams(std::move(beams));
+    graph->setName(name);
+    mGraphs.push_back(graph);
+    return LTC_ERROR::OK;
+  }
+
+  LTC::LTC_ERROR LTCModel::addGeometry(std::vector<Node>&& nodes,
+                                       std::vector<Beam>&& beams,
+                                       std::vector<Face>&& faces,
+                                       const std::string& name) {
+    auto graph = LTCGraph::create((int)mGraphs.size());
+    graph->setNodes(std::move(nodes));
+    graph->setBeams(std::move(beams));
+    graph->setFaces(std::move(faces));
+    graph->setName(name);
+    mGraphs.push_back(graph);
+    return LTC_ERROR::OK;
+  }
+
 }//namespace LTC
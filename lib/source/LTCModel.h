@@ -26,6 +26,7 @@
 
 #pragma once
 #include "LTCGraph.h"
+#include "LTCMesher.h"
 
 #include <tinyxml2.h>
 #include <memory>
@@ -64,10 +65,59 @@ namespace LTC {
     LTC_NO_LATTICE = 21,
     LTC_NO_NODES = 22,
     LTC_NO_BEAMS = 23,
+    LTC_INVALID_BINARY = 24,
+    LTC_UNSUPPORTED_VERSION = 25,
+    LTC_FILE_WRITE_ERROR = 26,
+    LTC_INVALID_ARCHIVE = 27,
 
   };
 
 
+  //! LTCFloatFormat
+  /*!
+  How the text writers print doubles.
+  EXACT_17G: "%.17g", byte compatible with tinyxml2 (writeToFile).
+  SHORTEST: the shortest digits that read back to the same double. Only
+  node values get shorter, so the saving depends on how much of the file
+  they are. Measured writing 200000 nodes with writeToFileStreaming, with
+  0 to 3 random beams per node: 1.1 - 2.4% for uniform random coordinates
+  in +-100 mm (about 2% without beams or radii) & 11 - 20% for nodes on a
+  0.1 mm grid; writes are faster either way.
+  */
+  enum class LTCFloatFormat {
+    EXACT_17G = 0,
+    SHORTEST = 1
+  };
+
+  //! LTCWriteOptions
+  /*!
+  Options for the streaming text writer.
+  mMaxSignificantDigits caps the digits per value (0 = no cap); capped
+  values are rounded & no longer read back bit exact.
+  */
+  struct LTCWriteOptions {
+    LTCFloatFormat mFloatFormat;
+    int mMaxSignificantDigits;
+
+    LTCWriteOptions() :
+      mFloatFormat(LTCFloatFormat::EXACT_17G),
+      mMaxSignificantDigits(0) {}
+  };
+
+  //! LTCMeshFormat
+  /*!
+  Triangle mesh file formats for LTCModel::writeMeshToFile, both binary &
+  little endian, in mm.
+  */
+  enum class LTCMeshFormat {
+    STL = 0,
+    PLY = 1
+  };
+
+
+  struct LTCGraphInfo;
+  class LTCGraphHandle;
+
   //! LTCModel
   /*!
   LTCModel is the parent interface for reading & writing Lattice Graph Objects.
@@ -91,19 +141,82 @@ namespace LTC {
       return std::make_shared<LTCModel>();
     }
   public:
-    LTCModel() {}
+    LTCModel() :
+      mNodeStorage(LTCNodeStorage::AOS),
+      mNodePrecision(LTCNodePrecision::FLOAT64) {}
+
+    //Node storage & precision for graphs created by the readers, see LTCGraph.
+    void setNodeStorage(LTCNodeStorage storage) { mNodeStorage = storage; }
+    LTCNodeStorage getNodeStorage()const { return mNodeStorage; }
+    void setNodePrecision(LTCNodePrecision precision) { mNodePrecision = precision; }
+    LTCNodePrecision getNodePrecision()const { return mNodePrecision; }
 
     LTC_ERROR readFromXml(tinyxml2::XMLDocument& doc);
     LTC_ERROR readFromText(const char* text, size_t numOfBytes);
     LTC_ERROR readFromFile(const char* path);
 
+    //Streaming readers, these never build an XMLDocument. A few malformed
+    //inputs read differently from readFromText, see LTCStreamReader.
+    LTC_ERROR readFromTextStreaming(const char* text, size_t numOfBytes);
+    LTC_ERROR readFromFileStreaming(const char* path);
+
+    //Streaming readers that parse graphs, or the groups of a single big
+    //graph, on numOfThreads threads (0 = all cores), same results as the
+    //streaming readers. See LTCParallelReader.
+    LTC_ERROR readFromTextParallel(const char* text, size_t numOfBytes,
+                                   unsigned int numOfThreads = 0);
+    LTC_ERROR readFromFileParallel(const char* path, unsigned int numOfThreads = 0);
+
     LTC_ERROR writeToXml(tinyxml2::XMLDocument* doc,
                          const std::string& comment);
     LTC_ERROR writeToFile(const char* path,
                           const std::string& comment);
 
+    //Streaming writer, same bytes as writeToFile without an XMLDocument
+    //when options are left at their defaults.
+    LTC_ERROR writeToFileStreaming(const char* path,
+                                   const std::string& comment,
+                                   const LTCWriteOptions& options = LTCWriteOptions());
+    //Streaming writer that formats elements on numOfThreads threads
+    //(0 = all cores), same bytes as writeToFileStreaming.
+    LTC_ERROR writeToFileParallel(const char* path,
+                                  const std::string& comment,
+                                  unsigned int numOfThreads = 0,
+                                  const LTCWriteOptions& options = LTCWriteOptions());
+
+    //Binary lattice (.ltcb) files, see LTCBinary.h for the layout.
+    LTC_ERROR readFromBinary(const char* path);
+    LTC_ERROR writeToBinary(const char* path);
+
+    //3MF packages with the Beam Lattice extension, for slicers that take
+    //beams directly. Nodes without a radius are written with defaultRadius
+    //(mm) unless another node has one, see LTC3MF.
+    LTC_ERROR readFrom3MF(const char* path);
+    LTC_ERROR writeTo3MF(const char* path, double defaultRadius = 0.5);
+
+    //Meshes every graph with LTCBeamMesher & writes the triangles as they
+    //are made, a chunk of parts at a time, so memory stays bounded however
+    //big the mesh. The mesh is a set of overlapping closed shells, not
+    //unioned. See LTCMeshWriter.
+    LTC_ERROR writeMeshToFile(const char* path,
+                              LTCMeshFormat format,
+                              const LTCMeshOptions& options = LTCMeshOptions());
+
     LTC_ERROR getTypes(const char* path, std::vector<GRAPH_TYPE>& types);
 
+    //Reads only the first graph with the given id / name from an .ltcx or
+    //.ltcb file & appends it. .ltcx files use the LTCGraphIndex sidecar
+    //written by writeGraphIndex if there is a current one, otherwise the
+    //graphs are located with a scan of the tags.
+    LTC_ERROR readGraph(const char* path, int id);
+    LTC_ERROR readGraph(const char* path, const std::string& name);
+    static LTC_ERROR writeGraphIndex(const char* path);
+
+    //Lists every graph without reading its geometry, see LTCGraphInfo.
+    static LTC_ERROR scanText(const char* text, size_t numOfBytes,
+                              std::vector<LTCGraphInfo>& infos);
+    static LTC_ERROR scanFile(const char* path, std::vector<LTCGraphInfo>& infos);
+
     //a few ways to add graphs to the model -- for writing out.
     LTC_ERROR addGeometry(const std::vector<Node>& nodes,
                           const std::vector<Beam>& beams,
@@ -113,14 +226,64 @@ namespace LTC {
                           const std::vector<Face>& faces,
                           const std::string& name);
 
+    //move the vectors in, nothing is copied
+    LTC_ERROR addGeometry(std::vector<Node>&& nodes,
+                          std::vector<Beam>&& beams,
+                          const std::string& name);
+    LTC_ERROR addGeometry(std::vector<Node>&& nodes,
+                          std::vector<Beam>&& beams,
+                          std::vector<Face>&& faces,
+                          const std::string& name);
+
     LTC_ERROR addGeometry(std::shared_ptr<LTCGraph> graph);
 
     const std::vector<LTCGraphP>& getGraphs()const { return mGraphs; }
 
+    //Lazy reading: only the list of graphs is read & each graph is parsed
+    //the first time its handle is asked for it, see LTCGraphHandle.
+    //Handles use the node storage & precision set when they were read.
+    LTC_ERROR readLazy(const char* path);
+    const std::vector<std::shared_ptr<LTCGraphHandle>>& getGraphHandles()const { return mGraphHandles; }
+    //Parses whatever the handles didn't yet & moves the graphs to getGraphs().
+    LTC_ERROR loadGraphs();
+
   private:
+    //exactly one of id & name is set
+    LTC_ERROR readGraph(const char* path, const int* id, const std::string* name);
+    LTC_ERROR readIndexedGraph(FILE* file, const char* path,
+                               const int* id, const std::string* name);
+    LTC_ERROR readBinaryGraph(FILE* file, const int* id, const std::string* name);
+
     std::vector<LTCGraphP> mGraphs;
+    std::vector<std::shared_ptr<LTCGraphHandle>> mGraphHandles;
+    LTCNodeStorage mNodeStorage;
+    LTCNodePrecision mNodePrecision;
   };
 
+  //! LTCGraphInfo
+  /*!
+  What LTCModel::scanText / scanFile report for a <graph>: its attributes
+  & how many node, beam & face elements its groups hold. Elements are
+  counted, not read, so a count includes nodes a reader would reject.
+  */
+  struct LTCGraphInfo {
+    int mID;
+    std::string mName;
+    LTCUnits mUnits;
+    LTCModel::GRAPH_TYPE mType;
+    size_t mNumOfNodes;
+    size_t mNumOfBeams;
+    size_t mNumOfFaces;
+
+    LTCGraphInfo() :
+      mID(0),
+      mName("no_name"),
+      mUnits(LTCUnits::MM),
+      mType(LTCModel::ROUND),
+      mNumOfNodes(0),
+      mNumOfBeams(0),
+      mNumOfFaces(0) {}
+  };
 
 
 
@@ -0,0 +1,205 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCNodeGrid.h"
+#include "LTCParallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LTC {
+
+  namespace {
+    //below this a single thread is quicker than scanning the buckets again
+    const size_t kMinNodesPerThread = 1 << 16;
+    const size_t kBlockSize = 1 << 14;
+    //cells are clamped so far out coordinates (or inf / NaN) still hash
+    const double kMaxCell = 4.0e18;
+
+    inline double squaredDistance(const double* a, const double b[3]) {
+      double dx = a[0] - b[0];
+      double dy = a[1] - b[1];
+      double dz = a[2] - b[2];
+      return dx * dx + dy * dy + dz * dz;
+    }
+  }
+
+  int64_t LTCNodeGrid::getCell(double value)const {
+    double cell = std::floor(value / mCellSize);
+    if ( !(cell > -kMaxCell) ) {
+      return cell != cell ? 0 : static_cast<int64_t>(-kMaxCell);
+    }
+    return static_cast<int64_t>(std::min(cell, kMaxCell));
+  }
+
+  size_t LTCNodeGrid::getBucket(int64_t x, int64_t y, int64_t z)const {
+    uint64_t h = static_cast<uint64_t>(x) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint64_t>(y) * 0xC2B2AE3D27D4EB4Full;
+    h ^= static_cast<uint64_t>(z) * 0x165667B19E3779F9ull;
+    h ^= h >> 32;
+    //the bucket count is a power of two
+    return static_cast<size_t>(h) & (getBucketCount() - 1);
+  }
+
+  std::shared_ptr<LTCNodeGrid> LTCNodeGrid::create(const LTCGraph& graph,
+                                                   double cellSize,
+                                                   unsigned int numOfThreads) {
+    if ( !(cellSize > 0.0) || !std::isfinite(cellSize) ) {
+      return nullptr;
+    }
+    std::shared_ptr<LTCNodeGrid> grid(new LTCNodeGrid(cellSize));
+    numOfThreads = resolveThreadCount(numOfThreads);
+    size_t numOfNodes = graph.getNodeCount();
+    size_t numOfBuckets = 1;
+    while ( numOfBuckets < numOfNodes ) {
+      numOfBuckets <<= 1;
+    }
+    grid->mOffsets.assign(numOfBuckets + 1, 0);
+
+    //bucket of every node
+    std::vector<uint32_t> buckets(numOfNodes);
+    std::vector<double> points(3 * numOfNodes);
+    size_t numOfBlocks = (numOfNodes + kBlockSize - 1) / kBlockSize;
+    parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+      size_t end = std::min((block + 1) * kBlockSize, numOfNodes);
+      for ( size_t i = block * kBlockSize; i < end; i++ ) {
+        Node node = graph.getNode(i);
+        points[3 * i] = node.mX;
+        points[3 * i + 1] = node.mY;
+        points[3 * i + 2] = node.mZ;
+        buckets[i] = static_cast<uint32_t>(grid->getBucket(grid->getCell(node.mX),
+                                                           grid->getCell(node.mY),
+                                                           grid->getCell(node.mZ)));
+      }
+    });
+
+    //every thread scans all nodes but counts & fills only its own buckets,
+    //so no writes are shared & buckets come out in node order
+    size_t numOfRanges = numOfNodes < kMinNodesPerThread ? 1 : numOfThreads;
+    auto rangeStart = [&](size_t r) {
+      return numOfBuckets * r / numOfRanges;
+    };
+    auto& offsets = grid->mOffsets;
+    parallelFor(numOfRanges, numOfThreads, [&](size_t r) {
+      size_t first = rangeStart(r);
+      size_t last = rangeStart(r + 1);
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        if ( buckets[i] >= first && buckets[i] < last ) {
+          offsets[buckets[i] + 1]++;
+        }
+      }
+    });
+    for ( size_t b = 0; b < numOfBuckets; b++ ) {
+      offsets[b + 1] += offsets[b];
+    }
+
+    grid->mNodes.resize(numOfNodes);
+    grid->mPoints.resize(3 * numOfNodes);
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    parallelFor(numOfRanges, numOfThreads, [&](size_t r) {
+      size_t first = rangeStart(r);
+      size_t last = rangeStart(r + 1);
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        if ( buckets[i] >= first && buckets[i] < last ) {
+          size_t slot = next[buckets[i]]++;
+          grid->mNodes[slot] = static_cast<int>(i);
+          std::copy(&points[3 * i], &points[3 * i] + 3, &grid->mPoints[3 * slot]);
+        }
+      }
+    });
+    return grid;
+  }
+
+  template <typename Fn>
+  void LTCNodeGrid::visit(const double point[3], double distance, Fn fn)const {
+    if ( mNodes.empty() || !(distance >= 0.0) ) {
+      return;
+    }
+    int64_t first[3], last[3];
+    double numOfCells = 1.0;
+    for ( int k = 0; k < 3; k++ ) {
+      first[k] = getCell(point[k] - distance);
+      last[k] = getCell(point[k] + distance);
+      numOfCells *= static_cast<double>(last[k] - first[k]) + 1.0;
+    }
+    if ( numOfCells >= static_cast<double>(getBucketCount()) ) {
+      //as many cells as buckets, every bucket gets looked at anyway
+      for ( size_t slot = 0; slot < mNodes.size(); slot++ ) {
+        fn(slot);
+      }
+      return;
+    }
+    for ( int64_t x = first[0]; x <= last[0]; x++ ) {
+      for ( int64_t y = first[1]; y <= last[1]; y++ ) {
+        for ( int64_t z = first[2]; z <= last[2]; z++ ) {
+          size_t bucket = getBucket(x, y, z);
+          for ( size_t slot = mOffsets[bucket]; slot < mOffsets[bucket + 1]; slot++ ) {
+            fn(slot);
+          }
+        }
+      }
+    }
+  }
+
+  void LTCNodeGrid::findWithin(const double point[3], double distance,
+                               std::vector<int>& nodes)const {
+    nodes.clear();
+    visit(point, distance, [&](size_t slot) {
+      if ( squaredDistance(&mPoints[3 * slot], point) <= distance * distance ) {
+        nodes.push_back(mNodes[slot]);
+      }
+    });
+    //cells sharing a bucket visit it more than once
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  }
+
+  int LTCNodeGrid::findNearest(const double point[3], double maxDistance)const {
+    int nearest = -1;
+    double best = maxDistance * maxDistance;
+    visit(point, maxDistance, [&](size_t slot) {
+      double d = squaredDistance(&mPoints[3 * slot], point);
+      if ( d < best || (d == best && (nearest < 0 || mNodes[slot] < nearest)) ) {
+        best = d;
+        nearest = mNodes[slot];
+      }
+    });
+    return nearest;
+  }
+
+  int LTCNodeGrid::findCoincident(const double point[3], double tolerance)const {
+    int found = -1;
+    visit(point, tolerance, [&](size_t slot) {
+      if ( (found < 0 || mNodes[slot] < found) &&
+           squaredDistance(&mPoints[3 * slot], point) <= tolerance * tolerance ) {
+        found = mNodes[slot];
+      }
+    });
+    return found;
+  }
+
+}//namespace LTC
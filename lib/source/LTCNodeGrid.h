@@ -0,0 +1,99 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCNodeGrid
+  /*!
+  Spatial hash grid over the nodes of a graph for coincident point &
+  range lookups. Space is cut into cubes of getCellSize(); each cube is
+  hashed into one of about as many buckets as there are nodes, so memory
+  stays proportional to the node count however sparse the lattice is.
+  Buckets hold node indices in ascending order, with a copy of their
+  positions next to them.
+
+  Built in O(N) like LTCAdjacency: with several threads each one owns a
+  range of buckets & fills only those. Queries are const & may run
+  concurrently. The grid copies the positions, it doesn't follow later
+  changes to the graph.
+
+  Pick a cell size near the usual query distance, e.g. the weld tolerance;
+  queries much larger than a cell visit many buckets.
+  */
+  class LTCNodeGrid {
+  public:
+    //! Builds on numOfThreads threads (0 = hardware threads), same result on any count.
+    /*!
+    Returns nullptr unless cellSize is positive & finite.
+    */
+    static std::shared_ptr<LTCNodeGrid> create(const LTCGraph& graph,
+                                               double cellSize,
+                                               unsigned int numOfThreads = 0);
+
+    //! Nodes within distance of point (inclusive), in ascending order.
+    void findWithin(const double point[3], double distance,
+                    std::vector<int>& nodes)const;
+
+    //! The node closest to point within maxDistance, lowest index on ties; -1 if none.
+    int findNearest(const double point[3], double maxDistance)const;
+
+    //! The lowest node index within tolerance of point, -1 if none.
+    /*!
+    With tolerance 0 only nodes at exactly point are found.
+    */
+    int findCoincident(const double point[3], double tolerance = 0.0)const;
+
+    double getCellSize()const { return mCellSize; }
+    size_t getNodeCount()const { return mNodes.size(); }
+    size_t getBucketCount()const { return mOffsets.size() - 1; }
+
+  private:
+    LTCNodeGrid(double cellSize) :
+      mCellSize{ cellSize } {}
+
+    int64_t getCell(double value)const;
+    size_t getBucket(int64_t x, int64_t y, int64_t z)const;
+
+    //! Calls fn(slot) for every node slot in buckets of cells within distance of point.
+    template <typename Fn>
+    void visit(const double point[3], double distance, Fn fn)const;
+
+    double mCellSize;
+    std::vector<size_t> mOffsets;  //bucket b holds slots [mOffsets[b], mOffsets[b + 1])
+    std::vector<int> mNodes;       //node index per slot
+    std::vector<double> mPoints;   //x, y, z per slot
+  };
+
+}//namespace LTC
@@ -0,0 +1,247 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCNodeOrder.h"
+#include "LTCAdjacency.h"
+#include "LTCParallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LTC {
+
+  namespace {
+    const size_t kBlockSize = 1 << 14;
+
+    //spreads the low 21 bits of v to every third bit
+    uint64_t spread(uint32_t v) {
+      uint64_t x = v & 0x1fffff;
+      x = (x | x << 32) & 0x1f00000000ffffull;
+      x = (x | x << 16) & 0x1f0000ff0000ffull;
+      x = (x | x << 8) & 0x100f00f00f00f00full;
+      x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+      x = (x | x << 2) & 0x1249249249249249ull;
+      return x;
+    }
+
+    void getCurveOrder(const LTCGraph& graph, LTCNodeOrder order,
+                       unsigned int numOfThreads, std::vector<int>& nodes) {
+      size_t numOfNodes = graph.getNodeCount();
+      size_t numOfBlocks = (numOfNodes + kBlockSize - 1) / kBlockSize;
+
+      //bounding box of the finite positions
+      std::vector<double> bounds(6 * numOfBlocks);
+      parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+        double* box = &bounds[6 * block];
+        std::fill(box, box + 3, HUGE_VAL);
+        std::fill(box + 3, box + 6, -HUGE_VAL);
+        size_t end = std::min((block + 1) * kBlockSize, numOfNodes);
+        for ( size_t i = block * kBlockSize; i < end; i++ ) {
+          Node node = graph.getNode(i);
+          double p[3] = { node.mX, node.mY, node.mZ };
+          for ( int k = 0; k < 3; k++ ) {
+            if ( std::isfinite(p[k]) ) {
+              box[k] = std::min(box[k], p[k]);
+              box[k + 3] = std::max(box[k + 3], p[k]);
+            }
+          }
+        }
+      });
+      double low[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL };
+      double high[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+      for ( size_t block = 0; block < numOfBlocks; block++ ) {
+        for ( int k = 0; k < 3; k++ ) {
+          low[k] = std::min(low[k], bounds[6 * block + k]);
+          high[k] = std::max(high[k], bounds[6 * block + k + 3]);
+        }
+      }
+      //one scale for all axes keeps the cells cubes
+      double extent = 0.0;
+      for ( int k = 0; k < 3; k++ ) {
+        if ( high[k] > low[k] ) {
+          extent = std::max(extent, high[k] - low[k]);
+        }
+      }
+      const double maxCell = static_cast<double>((1u << kCurveBits) - 1);
+      double scale = extent > 0.0 ? maxCell / extent : 0.0;
+
+      //key in the high bits, node in the low ones: sorting keeps ties in order
+      std::vector<std::pair<uint64_t, uint32_t>> keys(numOfNodes);
+      parallelFor(numOfBlocks, numOfThreads, [&](size_t block) {
+        size_t end = std::min((block + 1) * kBlockSize, numOfNodes);
+        for ( size_t i = block * kBlockSize; i < end; i++ ) {
+          Node node = graph.getNode(i);
+          double p[3] = { node.mX, node.mY, node.mZ };
+          uint32_t cell[3];
+          for ( int k = 0; k < 3; k++ ) {
+            double c = (p[k] - low[k]) * scale;
+            //NaN ends up in cell 0 along with the lowest nodes
+            c = c > 0.0 ? std::min(c, maxCell) : 0.0;
+            cell[k] = static_cast<uint32_t>(c);
+          }
+          uint64_t key = order == LTCNodeOrder::HILBERT ? getHilbertKey(cell[0], cell[1], cell[2])
+                                                        : getMortonKey(cell[0], cell[1], cell[2]);
+          keys[i] = std::make_pair(key, static_cast<uint32_t>(i));
+        }
+      });
+      parallelSort(keys.begin(), keys.end(), numOfThreads,
+                   [](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) {
+        return a < b;
+      });
+      nodes.resize(numOfNodes);
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        nodes[i] = static_cast<int>(keys[i].second);
+      }
+    }
+
+    //! Breadth first from start, lowest degree neighbours first.
+    /*!
+    Visited nodes get mark & end up in queue in visiting order; returns
+    the number of levels, lastLevel is where the deepest one starts.
+    */
+    size_t traverse(const LTCAdjacency& adjacency, int start, std::vector<int>& marks, int mark,
+                    std::vector<int>& queue, size_t& lastLevel) {
+      queue.clear();
+      queue.push_back(start);
+      marks[start] = mark;
+      size_t numOfLevels = 0;
+      size_t levelStart = 0;
+      while ( levelStart < queue.size() ) {
+        size_t levelEnd = queue.size();
+        lastLevel = levelStart;
+        numOfLevels++;
+        for ( size_t i = levelStart; i < levelEnd; i++ ) {
+          size_t first = queue.size();
+          for ( int n : adjacency.getNeighbors(queue[i]) ) {
+            if ( marks[n] != mark ) {
+              marks[n] = mark;
+              queue.push_back(n);
+            }
+          }
+          std::sort(queue.begin() + first, queue.end(), [&](int a, int b) {
+            size_t da = adjacency.getDegree(a);
+            size_t db = adjacency.getDegree(b);
+            return da < db || (da == db && a < b);
+          });
+        }
+        levelStart = levelEnd;
+      }
+      return numOfLevels;
+    }
+
+    void getRcmOrder(const LTCGraph& graph, unsigned int numOfThreads,
+                     std::vector<int>& nodes) {
+      auto adjacency = graph.getAdjacency(numOfThreads);
+      size_t numOfNodes = graph.getNodeCount();
+      //the search a node was last seen in, components are searched in turn
+      std::vector<int> marks(numOfNodes, 0);
+      std::vector<int> queue;
+      int mark = 0;
+      nodes.clear();
+      nodes.reserve(numOfNodes);
+      for ( size_t i = 0; i < numOfNodes; i++ ) {
+        if ( marks[i] != 0 ) {
+          continue;
+        }
+        //pseudo-peripheral start: move to the lowest degree node of the
+        //deepest level as long as that makes the component deeper
+        int start = static_cast<int>(i);
+        size_t lastLevel = 0;
+        size_t depth = traverse(*adjacency, start, marks, ++mark, queue, lastLevel);
+        for ( ;; ) {
+          int candidate = queue[lastLevel];
+          for ( size_t q = lastLevel + 1; q < queue.size(); q++ ) {
+            if ( adjacency->getDegree(queue[q]) < adjacency->getDegree(candidate) ) {
+              candidate = queue[q];
+            }
+          }
+          size_t candidateLevel = 0;
+          std::vector<int> candidateQueue;
+          size_t candidateDepth = traverse(*adjacency, candidate, marks, ++mark,
+                                           candidateQueue, candidateLevel);
+          if ( candidateDepth <= depth ) {
+            break;
+          }
+          start = candidate;
+          depth = candidateDepth;
+          lastLevel = candidateLevel;
+          queue.swap(candidateQueue);
+        }
+        //queue holds the search from start, the Cuthill-McKee order
+        nodes.insert(nodes.end(), queue.begin(), queue.end());
+      }
+      std::reverse(nodes.begin(), nodes.end());
+    }
+  }
+
+  uint64_t getMortonKey(uint32_t x, uint32_t y, uint32_t z) {
+    return spread(x) << 2 | spread(y) << 1 | spread(z);
+  }
+
+  uint64_t getHilbertKey(uint32_t x, uint32_t y, uint32_t z) {
+    //Skilling, "Programming the Hilbert curve" (2004): axes to transposed
+    //Hilbert index, which interleaves like a Morton key
+    uint32_t axes[3] = { x, y, z };
+    const uint32_t top = 1u << (kCurveBits - 1);
+    for ( uint32_t q = top; q > 1; q >>= 1 ) {
+      uint32_t p = q - 1;
+      for ( int i = 0; i < 3; i++ ) {
+        if ( axes[i] & q ) {
+          axes[0] ^= p;
+        }
+        else {
+          uint32_t t = (axes[0] ^ axes[i]) & p;
+          axes[0] ^= t;
+          axes[i] ^= t;
+        }
+      }
+    }
+    axes[1] ^= axes[0];
+    axes[2] ^= axes[1];
+    uint32_t t = 0;
+    for ( uint32_t q = top; q > 1; q >>= 1 ) {
+      if ( axes[2] & q ) {
+        t ^= q - 1;
+      }
+    }
+    for ( int i = 0; i < 3; i++ ) {
+      axes[i] ^= t;
+    }
+    return getMortonKey(axes[0], axes[1], axes[2]);
+  }
+
+  void getNodeOrder(const LTCGraph& graph, LTCNodeOrder order,
+                    unsigned int numOfThreads, std::vector<int>& nodes) {
+    if ( order == LTCNodeOrder::RCM ) {
+      getRcmOrder(graph, numOfThreads, nodes);
+    }
+    else {
+      getCurveOrder(graph, order, numOfThreads, nodes);
+    }
+  }
+
+}//namespace LTC
@@ -0,0 +1,64 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace LTC {
+
+  //! Bits per axis of the curve keys, 3 * 21 fit a 64 bit key.
+  const int kCurveBits = 21;
+
+  //! Morton (Z-order) key of cell x, y, z, each below 2^kCurveBits.
+  uint64_t getMortonKey(uint32_t x, uint32_t y, uint32_t z);
+
+  //! Hilbert key of cell x, y, z, each below 2^kCurveBits.
+  /*!
+  Cells with consecutive keys always share a face, unlike Morton order.
+  */
+  uint64_t getHilbertKey(uint32_t x, uint32_t y, uint32_t z);
+
+  //! getNodeOrder
+  /*!
+  The renumbering LTCGraph::reorderNodes applies: nodes[i] is the old
+  index of new node i.
+
+  MORTON & HILBERT quantize the positions to 2^kCurveBits cells per axis
+  of the bounding box, compute keys & sort on numOfThreads threads; nodes
+  in one cell keep their order. RCM runs breadth first from a
+  pseudo-peripheral node of each connected component (George & Liu),
+  lowest degree neighbours first, & reverses the result; it uses the
+  graph's adjacency & is sequential apart from building that. Nodes
+  without beams end up as components of their own.
+  */
+  void getNodeOrder(const LTCGraph& graph, LTCNodeOrder order,
+                    unsigned int numOfThreads, std::vector<int>& nodes);
+
+}//namespace LTC
@@ -0,0 +1,84 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include <cstddef>
+
+namespace LTC {
+
+  //! parseDouble
+  /*!
+  Parses a decimal floating point number from [first, last), accepting what
+  strtod / sscanf("%lf") accept: leading whitespace, an optional sign,
+  digits with an optional '.', and an optional exponent. The result is
+  correctly rounded, so it is bit-identical to strtod, but it never depends
+  on the current locale.
+
+  Up to 19 significant digits are handled with Clinger's fast path or the
+  Eisel-Lemire algorithm, longer inputs that those can't decide, as well as
+  inf/nan/hex forms, fall back to strtod.
+
+  Returns the end of the parsed number, or nullptr if nothing was converted
+  (value is left untouched, like tinyxml2's Query*Attribute).
+  */
+  const char* parseDouble(const char* first, const char* last, double& value);
+
+  //! parseInt
+  /*!
+  sscanf("%d") equivalent on [first, last), same return convention.
+  */
+  const char* parseInt(const char* first, const char* last, int& value);
+
+  //! formatShortest
+  /*!
+  Writes a decimal representation of value that parseDouble / strtod read
+  back to exactly the same double, using Grisu2. The digits are the
+  shortest possible for almost every input & never longer than 17.
+  Plain notation is used for decimal exponents in [-5, 17), scientific
+  otherwise; non-finite values are written as "inf", "-inf" & "nan".
+
+  buffer must hold at least 32 chars. Returns the number of chars written,
+  the buffer is not null terminated.
+  */
+  int formatShortest(double value, char* buffer);
+
+  //! formatShortest
+  /*!
+  Shortest digits that read back to the same float, for float32 data.
+  */
+  int formatShortest(float value, char* buffer);
+
+  //! formatPrecision
+  /*!
+  Like formatShortest, but with at most maxDigits significant digits. When
+  the shortest form needs more digits the value is rounded ("%.*g"), so it
+  no longer reads back exactly.
+  */
+  int formatPrecision(double value, int maxDigits, char* buffer);
+  int formatPrecision(float value, int maxDigits, char* buffer);
+
+}//namespace LTC
@@ -0,0 +1,115 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace LTC {
+
+  //! resolveThreadCount
+  /*!
+  0 means one thread per hardware thread.
+  */
+  inline unsigned int resolveThreadCount(unsigned int numOfThreads) {
+    if ( numOfThreads == 0 ) {
+      numOfThreads = std::thread::hardware_concurrency();
+    }
+    return std::max(numOfThreads, 1u);
+  }
+
+  //! parallelFor
+  /*!
+  Calls fn(i) for every i in [0, count) on up to numOfThreads threads
+  (the calling thread included). Items are handed out one at a time, so
+  uneven items balance themselves; make items coarse enough to be worth it.
+  fn must not throw.
+  */
+  template <typename Fn>
+  void parallelFor(size_t count, unsigned int numOfThreads, Fn fn) {
+    numOfThreads = resolveThreadCount(numOfThreads);
+    if ( numOfThreads == 1 || count <= 1 ) {
+      for ( size_t i = 0; i < count; i++ ) {
+        fn(i);
+      }
+      return;
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+      for ( size_t i = next++; i < count; i = next++ ) {
+        fn(i);
+      }
+    };
+    size_t numOfWorkers = std::min<size_t>(numOfThreads, count) - 1;
+    std::vector<std::thread> threads;
+    threads.reserve(numOfWorkers);
+    for ( size_t t = 0; t < numOfWorkers; t++ ) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for ( auto& thread : threads ) {
+      thread.join();
+    }
+  }
+
+  //! parallelSort
+  /*!
+  std::sort of [first, last) on up to numOfThreads threads: equal slices
+  are sorted side by side, then merged pairwise in rounds. Ranges below
+  minParallelCount are sorted on the calling thread. Not stable.
+  */
+  template <typename It, typename Less>
+  void parallelSort(It first, It last, unsigned int numOfThreads, Less less,
+                    size_t minParallelCount = 1 << 16) {
+    size_t count = last - first;
+    size_t numOfSlices = count < minParallelCount ? 1 : resolveThreadCount(numOfThreads);
+    if ( numOfSlices == 1 ) {
+      std::sort(first, last, less);
+      return;
+    }
+    auto sliceStart = [&](size_t slice) {
+      return first + count * std::min(slice, numOfSlices) / numOfSlices;
+    };
+    parallelFor(numOfSlices, numOfThreads, [&](size_t slice) {
+      std::sort(sliceStart(slice), sliceStart(slice + 1), less);
+    });
+    for ( size_t width = 1; width < numOfSlices; width *= 2 ) {
+      size_t numOfPairs = (numOfSlices + 2 * width - 1) / (2 * width);
+      parallelFor(numOfPairs, numOfThreads, [&](size_t pair) {
+        size_t left = 2 * width * pair;
+        if ( left + width < numOfSlices ) {
+          std::inplace_merge(sliceStart(left), sliceStart(left + width),
+                             sliceStart(left + 2 * width), less);
+        }
+      });
+    }
+  }
+
+}//namespace LTC
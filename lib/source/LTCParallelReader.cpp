@@ -0,0 +1,292 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCParallelReader.h"
+#include "LTCParallel.h"
+#include "LTCStreamReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LTC {
+
+  namespace {
+    bool startsWith(const char* p, const char* end, const char* prefix) {
+      size_t length = strlen(prefix);
+      return size_t(end - p) >= length && memcmp(p, prefix, length) == 0;
+    }
+
+    //first byte past terminator, or nullptr
+    const char* skipPast(const char* p, const char* end, const char* terminator) {
+      size_t length = strlen(terminator);
+      while ( p < end ) {
+        p = static_cast<const char*>(memchr(p, terminator[0], end - p));
+        if ( !p ) {
+          return nullptr;
+        }
+        if ( startsWith(p, end, terminator) ) {
+          return p + length;
+        }
+        ++p;
+      }
+      return nullptr;
+    }
+
+    //the '>' closing a tag, quoted attribute values may hold '>'
+    const char* findTagEnd(const char* p, const char* end) {
+      char quote = 0;
+      for ( ; p < end; ++p ) {
+        if ( quote ) {
+          if ( *p == quote ) {
+            quote = 0;
+          }
+        }
+        else if ( *p == '"' || *p == '\'' ) {
+          quote = *p;
+        }
+        else if ( *p == '>' ) {
+          return p;
+        }
+      }
+      return nullptr;
+    }
+
+    bool isNameChar(char c) {
+      return !(c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '/' || c == '>');
+    }
+
+    size_t nameLength(const char* p, const char* end) {
+      const char* q = p;
+      while ( q < end && isNameChar(*q) ) {
+        ++q;
+      }
+      return q - p;
+    }
+
+    struct OpenTag {
+      const char* mName;
+      size_t mLength;
+    };
+
+    //! Markup
+    /*!
+    What readMarkup found at a '<'.
+    */
+    struct Markup {
+      enum Kind {
+        SKIPPED = 0, // comment, CDATA, declaration
+        START = 1,
+        END = 2,
+        EMPTY = 3
+      };
+
+      Kind mKind;
+      const char* mName;
+      size_t mLength;
+    };
+
+    //! Reads the markup starting at p, returns the first byte past it or nullptr if malformed.
+    const char* readMarkup(const char* p, const char* end, Markup& markup) {
+      markup.mKind = Markup::SKIPPED;
+      if ( startsWith(p, end, "<!--") ) {
+        return skipPast(p + 4, end, "-->");
+      }
+      if ( startsWith(p, end, "<![CDATA[") ) {
+        return skipPast(p + 9, end, "]]>");
+      }
+      if ( startsWith(p, end, "<?") ) {
+        return skipPast(p + 2, end, "?>");
+      }
+      if ( startsWith(p, end, "<!") ) {
+        return skipPast(p + 2, end, ">");
+      }
+      bool isEnd = startsWith(p, end, "</");
+      markup.mName = p + (isEnd ? 2 : 1);
+      markup.mLength = nameLength(markup.mName, end);
+      auto tagEnd = findTagEnd(markup.mName + markup.mLength, end);
+      if ( !tagEnd || (!isEnd && markup.mLength == 0) ) {
+        return nullptr;
+      }
+      if ( isEnd ) {
+        markup.mKind = Markup::END;
+      }
+      else {
+        markup.mKind = tagEnd[-1] == '/' ? Markup::EMPTY : Markup::START;
+      }
+      return tagEnd + 1;
+    }
+
+    //! Pops the open tag an end tag closes, false if the names don't match.
+    bool close(std::vector<OpenTag>& open, const Markup& markup) {
+      if ( open.empty() || open.back().mLength != markup.mLength ||
+          memcmp(open.back().mName, markup.mName, markup.mLength) != 0 ) {
+        return false;
+      }
+      open.pop_back();
+      return true;
+    }
+  }
+
+  bool LTCParallelReader::findGraphs(const char* text, size_t numOfBytes,
+                                     std::vector<LTCTextRange>& ranges) {
+    const char* p = text;
+    const char* end = text + numOfBytes;
+    std::vector<OpenTag> open;
+    const char* graphStart = nullptr;
+    while ( p < end ) {
+      p = static_cast<const char*>(memchr(p, '<', end - p));
+      if ( !p ) {
+        break;
+      }
+      const char* tagStart = p;
+      Markup markup;
+      p = readMarkup(p, end, markup);
+      if ( !p ) {
+        return false;
+      }
+      if ( markup.mKind == Markup::END ) {
+        if ( !close(open, markup) ) {
+          return false;
+        }
+        if ( open.empty() && graphStart ) {
+          ranges.push_back({ size_t(graphStart - text), size_t(p - text) });
+          graphStart = nullptr;
+        }
+      }
+      else if ( markup.mKind != Markup::SKIPPED ) {
+        bool isGraph = markup.mLength == 5 && memcmp(markup.mName, "graph", 5) == 0;
+        if ( open.empty() && isGraph ) {
+          if ( markup.mKind == Markup::EMPTY ) {
+            ranges.push_back({ size_t(tagStart - text), size_t(p - text) });
+          }
+          else {
+            graphStart = tagStart;
+          }
+        }
+        if ( markup.mKind == Markup::START ) {
+          open.push_back({ markup.mName, markup.mLength });
+        }
+      }
+    }
+    return open.empty();
+  }
+
+  bool LTCParallelReader::splitGroup(const char* text, size_t numOfBytes, size_t begin,
+                                     const char* groupName, size_t chunkSize,
+                                     size_t maxNumOfChunks,
+                                     std::vector<LTCTextRange>& chunks, size_t& groupEnd) {
+    //cut at children of the group every chunkSize bytes or so, merged
+    //into at most maxNumOfChunks ranges once the group's size is known
+    std::vector<size_t> cuts(1, begin);
+    const char* p = text + begin;
+    const char* end = text + numOfBytes;
+    std::vector<OpenTag> open(1, OpenTag{ groupName, strlen(groupName) });
+    while ( !open.empty() ) {
+      p = static_cast<const char*>(memchr(p, '<', end - p));
+      if ( !p ) {
+        return false;
+      }
+      const char* tagStart = p;
+      Markup markup;
+      p = readMarkup(p, end, markup);
+      if ( !p ) {
+        return false;
+      }
+      if ( markup.mKind == Markup::END ) {
+        if ( !close(open, markup) ) {
+          return false;
+        }
+        if ( open.empty() ) {
+          cuts.push_back(tagStart - text);
+        }
+      }
+      else if ( markup.mKind != Markup::SKIPPED ) {
+        if ( open.size() == 1 && size_t(tagStart - text) - cuts.back() >= chunkSize ) {
+          cuts.push_back(tagStart - text);
+        }
+        if ( markup.mKind == Markup::START ) {
+          open.push_back({ markup.mName, markup.mLength });
+        }
+      }
+    }
+    groupEnd = p - text;
+
+    size_t groupSize = cuts.back() - begin;
+    size_t target = groupSize / std::max<size_t>(maxNumOfChunks, 1);
+    chunks.clear();
+    size_t chunkBegin = begin;
+    for ( size_t i = 1; i < cuts.size(); i++ ) {
+      if ( cuts[i] - chunkBegin >= target || i + 1 == cuts.size() ) {
+        chunks.push_back({ chunkBegin, cuts[i] });
+        chunkBegin = cuts[i];
+      }
+    }
+    return true;
+  }
+
+  LTC_ERROR LTCParallelReader::readSequential(const char* text, size_t numOfBytes,
+                                              std::vector<LTCGraphP>& graphs) {
+    LTCXmlScanner scanner(text, numOfBytes);
+    LTCStreamReader reader(scanner, mNodeStorage, mNodePrecision);
+    return reader.read(graphs);
+  }
+
+  LTC_ERROR LTCParallelReader::read(const char* text, size_t numOfBytes,
+                                    std::vector<LTCGraphP>& graphs) {
+    std::vector<LTCTextRange> ranges;
+    if ( !findGraphs(text, numOfBytes, ranges) || ranges.empty() ) {
+      return readSequential(text, numOfBytes, graphs);
+    }
+
+    //graphs always go in parallel, with fewer graphs than threads each
+    //graph's groups are split over the threads left over
+    unsigned int numOfThreads = resolveThreadCount(mNumOfThreads);
+    unsigned int graphThreads = static_cast<unsigned int>(
+      std::min<size_t>(numOfThreads, ranges.size()));
+    unsigned int groupThreads = std::max(1u, numOfThreads / graphThreads);
+
+    std::vector<std::vector<LTCGraphP>> results(ranges.size());
+    std::vector<LTC_ERROR> errors(ranges.size(), LTC_ERROR::OK);
+    parallelFor(ranges.size(), graphThreads, [&](size_t i) {
+      LTCXmlScanner scanner(text + ranges[i].mBegin, ranges[i].mEnd - ranges[i].mBegin);
+      LTCStreamReader reader(scanner, mNodeStorage, mNodePrecision);
+      reader.setNumOfThreads(groupThreads, mChunkSize);
+      errors[i] = reader.read(results[i]);
+    });
+
+    for ( auto err : errors ) {
+      if ( err != LTC_ERROR::OK ) {
+        return readSequential(text, numOfBytes, graphs);
+      }
+    }
+    for ( auto& result : results ) {
+      graphs.insert(graphs.end(), result.begin(), result.end());
+    }
+    return LTC_ERROR::OK;
+  }
+
+}//namespace LTC
@@ -0,0 +1,106 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCModel.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCTextRange
+  /*!
+  [mBegin, mEnd) byte offsets into a document.
+  */
+  struct LTCTextRange {
+    size_t mBegin;
+    size_t mEnd;
+  };
+
+  //! LTCParallelReader
+  /*!
+  Reads a whole in-memory .ltcx document on several threads.
+
+  A quick pass over the tags finds the top level <graph> elements, then
+  each one is parsed by an LTCStreamReader on a worker thread & the graphs
+  are handed back in document order. With fewer graphs than threads each
+  graph also gets its share of the remaining threads, its node, beam &
+  face groups are split into chunks that parse in parallel. The results
+  are exactly those of the sequential streaming reader, which differs
+  from the DOM reader in a few edge cases (see LTCStreamReader): whenever
+  the document is not well formed or a graph fails to parse, it is read
+  again sequentially so errors & partial results match too.
+  */
+  class LTCParallelReader {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    LTCParallelReader(unsigned int numOfThreads = 0,
+                      LTCNodeStorage storage = LTCNodeStorage::AOS,
+                      LTCNodePrecision precision = LTCNodePrecision::FLOAT64) :
+      mNumOfThreads(numOfThreads),
+      mNodeStorage(storage),
+      mNodePrecision(precision),
+      mChunkSize(1 << 20) {}
+
+    //! Smallest chunk a group is split into, see LTCStreamReader::setNumOfThreads.
+    void setChunkSize(size_t chunkSize) { mChunkSize = chunkSize; }
+
+    LTC_ERROR read(const char* text, size_t numOfBytes, std::vector<LTCGraphP>& graphs);
+
+    //! Ranges of the top level <graph> elements, start tag to end tag.
+    /*!
+    Returns false if the tags don't nest properly.
+    */
+    static bool findGraphs(const char* text, size_t numOfBytes,
+                           std::vector<LTCTextRange>& ranges);
+
+    //! Splits the children of a group element into chunks that parse on their own.
+    /*!
+    begin is just past the group's start tag. Chunks start at children of
+    the group, are about chunkSize bytes or more & together cover the group
+    up to its end tag; groupEnd is set past the end tag. Returns false if
+    the tags inside don't nest properly.
+    */
+    static bool splitGroup(const char* text, size_t numOfBytes, size_t begin,
+                           const char* groupName, size_t chunkSize,
+                           size_t maxNumOfChunks,
+                           std::vector<LTCTextRange>& chunks, size_t& groupEnd);
+
+  private:
+    LTC_ERROR readSequential(const char* text, size_t numOfBytes,
+                             std::vector<LTCGraphP>& graphs);
+
+    unsigned int mNumOfThreads;
+    LTCNodeStorage mNodeStorage;
+    LTCNodePrecision mNodePrecision;
+    size_t mChunkSize;
+  };
+
+}//namespace LTC
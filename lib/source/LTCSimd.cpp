@@ -0,0 +1,392 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCSimd.h"
+
+#include <atomic>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LTC_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//GCC & clang only emit AVX2 code in functions that ask for it, MSVC always can
+#if defined(LTC_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define LTC_TARGET_SSE2 __attribute__((target("sse2")))
+#define LTC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LTC_TARGET_SSE2
+#define LTC_TARGET_AVX2
+#endif
+
+namespace LTC {
+
+  namespace {
+#if defined(LTC_SIMD_X86)
+    void cpuid(int leaf, int subLeaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+      int r[4];
+      __cpuidex(r, leaf, subLeaf);
+      for ( int i = 0; i < 4; i++ ) {
+        regs[i] = static_cast<unsigned int>(r[i]);
+      }
+#else
+      __cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    //XCR0, which register state the OS saves on context switches
+    unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+      return _xgetbv(0);
+#else
+      unsigned int eax, edx;
+      __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+      return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    }
+#endif
+
+    LTCSimdLevel detectSimdLevel() {
+#if defined(LTC_SIMD_X86)
+      unsigned int regs[4];
+      cpuid(0, 0, regs);
+      unsigned int maxLeaf = regs[0];
+      cpuid(1, 0, regs);
+      bool sse2 = (regs[3] & (1u << 26)) != 0;
+      bool osxsave = (regs[2] & (1u << 27)) != 0;
+      bool avx = (regs[2] & (1u << 28)) != 0;
+      if ( maxLeaf >= 7 && osxsave && avx && (xgetbv0() & 0x6) == 0x6 ) {
+        cpuid(7, 0, regs);
+        if ( regs[1] & (1u << 5) ) {
+          return LTCSimdLevel::AVX2;
+        }
+      }
+      return sse2 ? LTCSimdLevel::SSE2 : LTCSimdLevel::SCALAR;
+#else
+      return LTCSimdLevel::SCALAR;
+#endif
+    }
+
+    std::atomic<int> gSimdLevelCap(static_cast<int>(LTCSimdLevel::AVX2));
+
+    //
+    // Scalar kernels, also used for the tails of the vector loops
+    //
+
+    template <typename T>
+    void scaleValuesScalar(T* values, size_t count, double factor) {
+      for ( size_t i = 0; i < count; i++ ) {
+        values[i] = static_cast<T>(values[i] * factor);
+      }
+    }
+
+    template <typename T>
+    void scaleRadiusScalar(T* radius, size_t count, double factor) {
+      for ( size_t i = 0; i < count; i++ ) {
+        if ( radius[i] != T(-1) ) {
+          radius[i] = static_cast<T>(radius[i] * factor);
+        }
+      }
+    }
+
+    template <typename T>
+    void scaleOrientationScalar(T* s[3], T* e[3], size_t count, double factor) {
+      for ( size_t i = 0; i < count; i++ ) {
+        if ( s[0][i] != e[0][i] || s[1][i] != e[1][i] || s[2][i] != e[2][i] ) {
+          for ( int k = 0; k < 3; k++ ) {
+            s[k][i] = static_cast<T>(s[k][i] * factor);
+            e[k][i] = static_cast<T>(e[k][i] * factor);
+          }
+        }
+      }
+    }
+
+    //per node factors: orientation & radius are left alone by multiplying with 1
+    inline double orientationFactor(const Node& n, double factor) {
+      return n.mXS != n.mXE || n.mYS != n.mYE || n.mZS != n.mZE ? factor : 1.0;
+    }
+
+    inline double radiusFactor(const Node& n, double factor) {
+      return n.mRadius != -1.0 ? factor : 1.0;
+    }
+
+    void scaleNodesScalar(Node* nodes, size_t count, double factor) {
+      for ( size_t i = 0; i < count; i++ ) {
+        Node& n = nodes[i];
+        double of = orientationFactor(n, factor);
+        n.mX *= factor;
+        n.mY *= factor;
+        n.mZ *= factor;
+        n.mXS *= of;
+        n.mYS *= of;
+        n.mZS *= of;
+        n.mXE *= of;
+        n.mYE *= of;
+        n.mZE *= of;
+        n.mRadius *= radiusFactor(n, factor);
+      }
+    }
+
+#if defined(LTC_SIMD_X86)
+    //
+    // SSE2, 2 doubles per register
+    //
+
+    LTC_TARGET_SSE2 inline __m128d selectSse2(__m128d mask, __m128d a, __m128d b) {
+      return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+    LTC_TARGET_SSE2 inline __m128d loadFloatsSse2(const float* p) {
+      return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+    }
+
+    LTC_TARGET_SSE2 inline void storeFloatsSse2(float* p, __m128d v) {
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(_mm_cvtpd_ps(v)));
+    }
+
+    LTC_TARGET_SSE2 inline __m128d loadSse2(const double* p) { return _mm_loadu_pd(p); }
+    LTC_TARGET_SSE2 inline __m128d loadSse2(const float* p) { return loadFloatsSse2(p); }
+    LTC_TARGET_SSE2 inline void storeSse2(double* p, __m128d v) { _mm_storeu_pd(p, v); }
+    LTC_TARGET_SSE2 inline void storeSse2(float* p, __m128d v) { storeFloatsSse2(p, v); }
+
+    template <typename T>
+    LTC_TARGET_SSE2 void scaleValuesSse2(T* values, size_t count, double factor) {
+      const __m128d f = _mm_set1_pd(factor);
+      size_t i = 0;
+      for ( ; i + 2 <= count; i += 2 ) {
+        storeSse2(values + i, _mm_mul_pd(loadSse2(values + i), f));
+      }
+      scaleValuesScalar(values + i, count - i, factor);
+    }
+
+    template <typename T>
+    LTC_TARGET_SSE2 void scaleRadiusSse2(T* radius, size_t count, double factor) {
+      const __m128d f = _mm_set1_pd(factor);
+      const __m128d none = _mm_set1_pd(-1.0);
+      size_t i = 0;
+      for ( ; i + 2 <= count; i += 2 ) {
+        __m128d r = loadSse2(radius + i);
+        __m128d keep = _mm_cmpeq_pd(r, none);
+        storeSse2(radius + i, selectSse2(keep, r, _mm_mul_pd(r, f)));
+      }
+      scaleRadiusScalar(radius + i, count - i, factor);
+    }
+
+    template <typename T>
+    LTC_TARGET_SSE2 void scaleOrientationSse2(T* s[3], T* e[3], size_t count, double factor) {
+      const __m128d f = _mm_set1_pd(factor);
+      size_t i = 0;
+      for ( ; i + 2 <= count; i += 2 ) {
+        __m128d vs[3], ve[3];
+        __m128d oriented = _mm_setzero_pd();
+        for ( int k = 0; k < 3; k++ ) {
+          vs[k] = loadSse2(s[k] + i);
+          ve[k] = loadSse2(e[k] + i);
+          //cmpneq is unordered, true for NaN like operator!=
+          oriented = _mm_or_pd(oriented, _mm_cmpneq_pd(vs[k], ve[k]));
+        }
+        for ( int k = 0; k < 3; k++ ) {
+          storeSse2(s[k] + i, selectSse2(oriented, _mm_mul_pd(vs[k], f), vs[k]));
+          storeSse2(e[k] + i, selectSse2(oriented, _mm_mul_pd(ve[k], f), ve[k]));
+        }
+      }
+      T* sTail[3] = { s[0] + i, s[1] + i, s[2] + i };
+      T* eTail[3] = { e[0] + i, e[1] + i, e[2] + i };
+      scaleOrientationScalar(sTail, eTail, count - i, factor);
+    }
+
+    //Node is x y z xs ys zs xe ye ze r, five register pairs
+    LTC_TARGET_SSE2 void scaleNodesSse2(Node* nodes, size_t count, double factor) {
+      const __m128d f = _mm_set1_pd(factor);
+      for ( size_t i = 0; i < count; i++ ) {
+        double* p = &nodes[i].mX;
+        double of = orientationFactor(nodes[i], factor);
+        double rf = radiusFactor(nodes[i], factor);
+        const __m128d o = _mm_set1_pd(of);
+        _mm_storeu_pd(p + 0, _mm_mul_pd(_mm_loadu_pd(p + 0), f));
+        _mm_storeu_pd(p + 2, _mm_mul_pd(_mm_loadu_pd(p + 2), _mm_set_pd(of, factor)));
+        _mm_storeu_pd(p + 4, _mm_mul_pd(_mm_loadu_pd(p + 4), o));
+        _mm_storeu_pd(p + 6, _mm_mul_pd(_mm_loadu_pd(p + 6), o));
+        _mm_storeu_pd(p + 8, _mm_mul_pd(_mm_loadu_pd(p + 8), _mm_set_pd(rf, of)));
+      }
+    }
+
+    //
+    // AVX2, 4 doubles per register
+    //
+
+    LTC_TARGET_AVX2 inline __m256d loadAvx2(const double* p) { return _mm256_loadu_pd(p); }
+    LTC_TARGET_AVX2 inline __m256d loadAvx2(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+    LTC_TARGET_AVX2 inline void storeAvx2(double* p, __m256d v) { _mm256_storeu_pd(p, v); }
+    LTC_TARGET_AVX2 inline void storeAvx2(float* p, __m256d v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+
+    template <typename T>
+    LTC_TARGET_AVX2 void scaleValuesAvx2(T* values, size_t count, double factor) {
+      const __m256d f = _mm256_set1_pd(factor);
+      size_t i = 0;
+      for ( ; i + 4 <= count; i += 4 ) {
+        storeAvx2(values + i, _mm256_mul_pd(loadAvx2(values + i), f));
+      }
+      scaleValuesScalar(values + i, count - i, factor);
+    }
+
+    template <typename T>
+    LTC_TARGET_AVX2 void scaleRadiusAvx2(T* radius, size_t count, double factor) {
+      const __m256d f = _mm256_set1_pd(factor);
+      const __m256d none = _mm256_set1_pd(-1.0);
+      size_t i = 0;
+      for ( ; i + 4 <= count; i += 4 ) {
+        __m256d r = loadAvx2(radius + i);
+        __m256d keep = _mm256_cmp_pd(r, none, _CMP_EQ_OQ);
+        storeAvx2(radius + i, _mm256_blendv_pd(_mm256_mul_pd(r, f), r, keep));
+      }
+      scaleRadiusScalar(radius + i, count - i, factor);
+    }
+
+    template <typename T>
+    LTC_TARGET_AVX2 void scaleOrientationAvx2(T* s[3], T* e[3], size_t count, double factor) {
+      const __m256d f = _mm256_set1_pd(factor);
+      size_t i = 0;
+      for ( ; i + 4 <= count; i += 4 ) {
+        __m256d vs[3], ve[3];
+        __m256d oriented = _mm256_setzero_pd();
+        for ( int k = 0; k < 3; k++ ) {
+          vs[k] = loadAvx2(s[k] + i);
+          ve[k] = loadAvx2(e[k] + i);
+          oriented = _mm256_or_pd(oriented, _mm256_cmp_pd(vs[k], ve[k], _CMP_NEQ_UQ));
+        }
+        for ( int k = 0; k < 3; k++ ) {
+          storeAvx2(s[k] + i, _mm256_blendv_pd(vs[k], _mm256_mul_pd(vs[k], f), oriented));
+          storeAvx2(e[k] + i, _mm256_blendv_pd(ve[k], _mm256_mul_pd(ve[k], f), oriented));
+        }
+      }
+      T* sTail[3] = { s[0] + i, s[1] + i, s[2] + i };
+      T* eTail[3] = { e[0] + i, e[1] + i, e[2] + i };
+      scaleOrientationScalar(sTail, eTail, count - i, factor);
+    }
+
+    //Node is x y z xs | ys zs xe ye | ze r
+    LTC_TARGET_AVX2 void scaleNodesAvx2(Node* nodes, size_t count, double factor) {
+      for ( size_t i = 0; i < count; i++ ) {
+        double* p = &nodes[i].mX;
+        double of = orientationFactor(nodes[i], factor);
+        double rf = radiusFactor(nodes[i], factor);
+        _mm256_storeu_pd(p + 0, _mm256_mul_pd(_mm256_loadu_pd(p + 0),
+                                              _mm256_set_pd(of, factor, factor, factor)));
+        _mm256_storeu_pd(p + 4, _mm256_mul_pd(_mm256_loadu_pd(p + 4), _mm256_set1_pd(of)));
+        _mm_storeu_pd(p + 8, _mm_mul_pd(_mm_loadu_pd(p + 8), _mm_set_pd(rf, of)));
+      }
+    }
+#endif
+
+    template <typename T>
+    void scaleValues(T* values, size_t count, double factor) {
+#if defined(LTC_SIMD_X86)
+      switch ( getSimdLevel() ) {
+      case LTCSimdLevel::AVX2: scaleValuesAvx2(values, count, factor); return;
+      case LTCSimdLevel::SSE2: scaleValuesSse2(values, count, factor); return;
+      default: break;
+      }
+#endif
+      scaleValuesScalar(values, count, factor);
+    }
+
+    template <typename T>
+    void scaleRadius(T* radius, size_t count, double factor) {
+#if defined(LTC_SIMD_X86)
+      switch ( getSimdLevel() ) {
+      case LTCSimdLevel::AVX2: scaleRadiusAvx2(radius, count, factor); return;
+      case LTCSimdLevel::SSE2: scaleRadiusSse2(radius, count, factor); return;
+      default: break;
+      }
+#endif
+      scaleRadiusScalar(radius, count, factor);
+    }
+
+    template <typename T>
+    void scaleOrientation(T* s[3], T* e[3], size_t count, double factor) {
+#if defined(LTC_SIMD_X86)
+      switch ( getSimdLevel() ) {
+      case LTCSimdLevel::AVX2: scaleOrientationAvx2(s, e, count, factor); return;
+      case LTCSimdLevel::SSE2: scaleOrientationSse2(s, e, count, factor); return;
+      default: break;
+      }
+#endif
+      scaleOrientationScalar(s, e, count, factor);
+    }
+
+    template <typename T>
+    void scaleNodeArrays(NodeArraysT<T>& nodes, double factor) {
+      size_t count = nodes.size();
+      scaleValues(nodes.mX.data(), count, factor);
+      scaleValues(nodes.mY.data(), count, factor);
+      scaleValues(nodes.mZ.data(), count, factor);
+      scaleRadius(nodes.mRadius.data(), count, factor);
+      if ( nodes.hasOrientation() ) {
+        T* s[3] = { nodes.mXS.data(), nodes.mYS.data(), nodes.mZS.data() };
+        T* e[3] = { nodes.mXE.data(), nodes.mYE.data(), nodes.mZE.data() };
+        scaleOrientation(s, e, count, factor);
+      }
+    }
+  }
+
+  LTCSimdLevel getSimdLevel() {
+    static const LTCSimdLevel detected = detectSimdLevel();
+    int cap = gSimdLevelCap.load(std::memory_order_relaxed);
+    return static_cast<int>(detected) < cap ? detected : static_cast<LTCSimdLevel>(cap);
+  }
+
+  void setSimdLevel(LTCSimdLevel level) {
+    gSimdLevelCap.store(static_cast<int>(level), std::memory_order_relaxed);
+  }
+
+  void scaleNodes(Node* nodes, size_t count, double factor) {
+#if defined(LTC_SIMD_X86)
+    switch ( getSimdLevel() ) {
+    case LTCSimdLevel::AVX2: scaleNodesAvx2(nodes, count, factor); return;
+    case LTCSimdLevel::SSE2: scaleNodesSse2(nodes, count, factor); return;
+    default: break;
+    }
+#endif
+    scaleNodesScalar(nodes, count, factor);
+  }
+
+  void scaleNodes(NodeArrays& nodes, double factor) {
+    scaleNodeArrays(nodes, factor);
+  }
+
+  void scaleNodes(NodeArraysF& nodes, double factor) {
+    scaleNodeArrays(nodes, factor);
+  }
+
+}//namespace LTC
@@ -0,0 +1,67 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+
+#include <cstddef>
+
+namespace LTC {
+
+  //! LTCSimdLevel
+  /*!
+  Instruction sets the kernels in LTCSimd.cpp are compiled for. The best
+  one the CPU & OS support is picked at runtime.
+  */
+  enum class LTCSimdLevel {
+    SCALAR = 0,
+    SSE2 = 1,
+    AVX2 = 2
+  };
+
+  //! Level in use, detected on first call.
+  LTCSimdLevel getSimdLevel();
+
+  //! Caps the level in use, e.g. to compare kernels. Never raises it past
+  //! what the CPU supports.
+  void setSimdLevel(LTCSimdLevel level);
+
+  //! scaleNodes
+  /*!
+  Multiplies node positions, radii & orientation by factor, exactly as
+  LTCGraph::addNode applies its unit factor:
+    x y z     always
+    r         unless it is the -1 "no radius" sentinel
+    xs .. ze  only for oriented nodes (start != end)
+  Results are bit identical across SIMD levels.
+  */
+  void scaleNodes(Node* nodes, size_t count, double factor);
+  void scaleNodes(NodeArrays& nodes, double factor);
+  //! float values are scaled in double & rounded once
+  void scaleNodes(NodeArraysF& nodes, double factor);
+
+}//namespace LTC
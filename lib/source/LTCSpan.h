@@ -0,0 +1,69 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCSpan
+  /*!
+  Non-owning view of a contiguous array, the bits of std::span we need.
+  */
+  template <typename T>
+  class LTCSpan {
+  public:
+    LTCSpan() :
+      mData(nullptr),
+      mSize(0) {}
+    LTCSpan(T* data, size_t size) :
+      mData(data),
+      mSize(size) {}
+    template <typename U, typename Alloc>
+    LTCSpan(std::vector<U, Alloc>& values) :
+      mData(values.data()),
+      mSize(values.size()) {}
+    template <typename U, typename Alloc>
+    LTCSpan(const std::vector<U, Alloc>& values) :
+      mData(values.data()),
+      mSize(values.size()) {}
+
+    T* data()const { return mData; }
+    size_t size()const { return mSize; }
+    bool empty()const { return mSize == 0; }
+
+    T* begin()const { return mData; }
+    T* end()const { return mData + mSize; }
+    T& operator[](size_t i)const { return mData[i]; }
+
+  private:
+    T* mData;
+    size_t mSize;
+  };
+
+}//namespace LTC
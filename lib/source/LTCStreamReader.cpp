@@ -0,0 +1,1003 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCStreamReader.h"
+#include "LTCNumber.h"
+#include "LTCParallel.h"
+#include "LTCParallelReader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace LTC {
+
+  namespace {
+    inline bool isSpace(char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    inline bool isNameStartChar(char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        c == '_' || c == ':' || static_cast<unsigned char>(c) >= 128;
+    }
+
+    inline bool isNameChar(char c) {
+      return isNameStartChar(c) || (c >= '0' && c <= '9') ||
+        c == '.' || c == '-';
+    }
+
+    inline bool equals(const char* str, size_t length, const char* name) {
+      return strncmp(str, name, length) == 0 && name[length] == 0;
+    }
+
+    bool toDouble(const LTCXmlAttribute& attribute, double& value) {
+      return parseDouble(attribute.mValue, attribute.mValue + attribute.mValueLength, value) != nullptr;
+    }
+
+    bool toInt(const LTCXmlAttribute& attribute, int& value) {
+      return parseInt(attribute.mValue, attribute.mValue + attribute.mValueLength, value) != nullptr;
+    }
+
+    void appendUTF8(unsigned long ucs, std::string& out) {
+      if ( ucs < 0x80 ) {
+        out += static_cast<char>(ucs);
+      }
+      else if ( ucs < 0x800 ) {
+        out += static_cast<char>(0xC0 | (ucs >> 6));
+        out += static_cast<char>(0x80 | (ucs & 0x3F));
+      }
+      else if ( ucs < 0x10000 ) {
+        out += static_cast<char>(0xE0 | (ucs >> 12));
+        out += static_cast<char>(0x80 | ((ucs >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (ucs & 0x3F));
+      }
+      else if ( ucs < 0x200000 ) {
+        out += static_cast<char>(0xF0 | (ucs >> 18));
+        out += static_cast<char>(0x80 | ((ucs >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((ucs >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (ucs & 0x3F));
+      }
+    }
+  }
+
+  bool LTCXmlAttribute::is(const char* name)const {
+    return equals(mName, mNameLength, name);
+  }
+
+  bool LTCXmlAttribute::valueIs(const char* value)const {
+    return equals(mValue, mValueLength, value);
+  }
+
+  bool LTCXmlTag::is(const char* name)const {
+    return equals(mName, mNameLength, name);
+  }
+
+  const LTCXmlAttribute* LTCXmlTag::find(const char* name)const {
+    for ( auto& attribute : mAttributes ) {
+      if ( attribute.is(name) ) {
+        return &attribute;
+      }
+    }
+    return nullptr;
+  }
+
+  namespace {
+    //! Appends the nodes, beams & faces of parts to graph, in order.
+    void appendParts(LTCGraph& graph, const std::vector<std::shared_ptr<LTCGraph>>& parts) {
+      size_t numOfNodes = graph.getNodeCount();
+      size_t numOfBeams = graph.getBeams().size();
+      size_t numOfFaces = graph.getFaces().size();
+      for ( auto& part : parts ) {
+        numOfNodes += part->getNodeCount();
+        numOfBeams += part->getBeams().size();
+        numOfFaces += part->getFaces().size();
+      }
+
+      if ( numOfNodes != graph.getNodeCount() ) {
+        if ( graph.getNodeStorage() == LTCNodeStorage::AOS ) {
+          std::vector<Node> nodes;
+          nodes.reserve(numOfNodes);
+          nodes.insert(nodes.end(), graph.getNodes().begin(), graph.getNodes().end());
+          for ( auto& part : parts ) {
+            nodes.insert(nodes.end(), part->getNodes().begin(), part->getNodes().end());
+          }
+          graph.setNodes(std::move(nodes));
+        }
+        else if ( graph.getNodePrecision() == LTCNodePrecision::FLOAT32 ) {
+          NodeArraysF arrays = graph.getNodeArraysF();
+          for ( auto& part : parts ) {
+            arrays.append(part->getNodeArraysF());
+          }
+          graph.setNodeArrays(std::move(arrays));
+        }
+        else {
+          NodeArrays arrays = graph.getNodeArrays();
+          for ( auto& part : parts ) {
+            arrays.append(part->getNodeArrays());
+          }
+          graph.setNodeArrays(std::move(arrays));
+        }
+      }
+
+      graph.reserve(numOfNodes, numOfBeams, numOfFaces);
+      for ( auto& part : parts ) {
+        graph.addBeams(part->getBeams());
+        graph.addFaces(part->getFaces());
+      }
+    }
+  }
+
+  LTCXmlScanner::LTCXmlScanner(const char* text, size_t numOfBytes) :
+    mFile(nullptr),
+    mData(text),
+    mPos(0),
+    mEnd(numOfBytes),
+    mEof(true),
+    mSkipAttributes(false),
+    mError(LTC_ERROR::OK) {}
+
+  LTCXmlScanner::LTCXmlScanner(FILE* file, size_t chunkSize) :
+    mFile(file),
+    mBuffer(std::max<size_t>(chunkSize, 16)),
+    mData(mBuffer.data()),
+    mPos(0),
+    mEnd(0),
+    mEof(false),
+    mSkipAttributes(false),
+    mError(LTC_ERROR::OK) {}
+
+  bool LTCXmlScanner::refill() {
+    if ( mEof ) {
+      return false;
+    }
+    //keep everything from mPos on, the caller still needs it
+    size_t remaining = mEnd - mPos;
+    if ( mPos > 0 ) {
+      memmove(mBuffer.data(), mBuffer.data() + mPos, remaining);
+      mPos = 0;
+      mEnd = remaining;
+    }
+    if ( mEnd == mBuffer.size() ) {
+      mBuffer.resize(mBuffer.size() * 2);
+    }
+    mData = mBuffer.data();
+
+    size_t numRead = fread(mBuffer.data() + mEnd, 1, mBuffer.size() - mEnd, mFile);
+    if ( numRead == 0 ) {
+      if ( ferror(mFile) ) {
+        mError = LTC_ERROR::XML_ERROR_FILE_READ_ERROR;
+      }
+      mEof = true;
+      return false;
+    }
+    mEnd += numRead;
+    return true;
+  }
+
+  bool LTCXmlScanner::skipPast(const char* terminator, size_t length, size_t offset,
+                               LTC_ERROR error) {
+    size_t search = mPos + offset;
+    while ( true ) {
+      const char* begin = mData + std::min(search, mEnd);
+      const char* end = mData + mEnd;
+      const char* found = std::search(begin, end, terminator, terminator + length);
+      if ( found != end ) {
+        mPos = (found - mData) + length;
+        return true;
+      }
+      //drop what was searched, but keep a possible partial terminator
+      size_t keep = std::min<size_t>(length - 1, end - begin);
+      mPos = mEnd - keep;
+      if ( !refill() ) {
+        if ( mError == LTC_ERROR::OK ) {
+          mError = error;
+        }
+        return false;
+      }
+      search = mPos;
+    }
+  }
+
+  bool LTCXmlScanner::parseTag(LTCXmlTag& tag, bool& needMore) {
+    const char* p = mData + mPos + 1;
+    const char* end = mData + mEnd;
+    needMore = false;
+    tag.mAttributes.clear();
+
+    bool closing = false;
+    if ( p < end && *p == '/' ) {
+      closing = true;
+      ++p;
+    }
+    const char* name = p;
+    while ( p < end && isNameChar(*p) ) {
+      ++p;
+    }
+    if ( p == end ) {
+      needMore = true;
+      return false;
+    }
+    if ( p == name || !isNameStartChar(*name) ) {
+      mError = LTC_ERROR::XML_ERROR_PARSING_ELEMENT;
+      return false;
+    }
+    tag.mName = name;
+    tag.mNameLength = p - name;
+
+    if ( closing ) {
+      while ( p < end && isSpace(*p) ) {
+        ++p;
+      }
+      if ( p == end ) {
+        needMore = true;
+        return false;
+      }
+      if ( *p != '>' ) {
+        mError = LTC_ERROR::XML_ERROR_PARSING_ELEMENT;
+        return false;
+      }
+      tag.mKind = LTCXmlTag::END;
+      mPos = (p + 1) - mData;
+      return true;
+    }
+
+    if ( mSkipAttributes ) {
+      //just find the '>', quoted values may hold one
+      char quote = 0;
+      for ( ; p < end; ++p ) {
+        if ( quote ) {
+          if ( *p == quote ) {
+            quote = 0;
+          }
+        }
+        else if ( *p == '\"' || *p == '\'' ) {
+          quote = *p;
+        }
+        else if ( *p == '>' ) {
+          tag.mKind = p[-1] == '/' ? LTCXmlTag::EMPTY : LTCXmlTag::START;
+          mPos = (p + 1) - mData;
+          return true;
+        }
+      }
+      needMore = true;
+      return false;
+    }
+
+    while ( true ) {
+      while ( p < end && isSpace(*p) ) {
+        ++p;
+      }
+      if ( p == end ) {
+        needMore = true;
+        return false;
+      }
+      if ( *p == '>' ) {
+        tag.mKind = LTCXmlTag::START;
+        mPos = (p + 1) - mData;
+        return true;
+      }
+      if ( *p == '/' ) {
+        if ( p + 1 == end ) {
+          needMore = true;
+          return false;
+        }
+        if ( p[1] != '>' ) {
+          mError = LTC_ERROR::XML_ERROR_PARSING_ELEMENT;
+          return false;
+        }
+        tag.mKind = LTCXmlTag::EMPTY;
+        mPos = (p + 2) - mData;
+        return true;
+      }
+      if ( !isNameStartChar(*p) ) {
+        mError = LTC_ERROR::XML_ERROR_PARSING_ELEMENT;
+        return false;
+      }
+
+      LTCXmlAttribute attribute;
+      attribute.mName = p;
+      while ( p < end && isNameChar(*p) ) {
+        ++p;
+      }
+      attribute.mNameLength = p - attribute.mName;
+      while ( p < end && isSpace(*p) ) {
+        ++p;
+      }
+      if ( p == end ) {
+        needMore = true;
+        return false;
+      }
+      if ( *p != '=' ) {
+        mError = LTC_ERROR::XML_ERROR_PARSING_ATTRIBUTE;
+        return false;
+      }
+      ++p;
+      while ( p < end && isSpace(*p) ) {
+        ++p;
+      }
+      if ( p == end ) {
+        needMore = true;
+        return false;
+      }
+      if ( *p != '\"' && *p != '\'' ) {
+        mError = LTC_ERROR::XML_ERROR_PARSING_ATTRIBUTE;
+        return false;
+      }
+      const char quote = *p++;
+      auto close = static_cast<const char*>(memchr(p, quote, end - p));
+      if ( !close ) {
+        needMore = true;
+        return false;
+      }
+      attribute.mValue = p;
+      attribute.mValueLength = close - p;
+      tag.mAttributes.push_back(attribute);
+      p = close + 1;
+    }
+  }
+
+  bool LTCXmlScanner::next(LTCXmlTag& tag) {
+    if ( mError != LTC_ERROR::OK ) {
+      return false;
+    }
+    while ( true ) {
+      auto lt = static_cast<const char*>(memchr(mData + mPos, '<', mEnd - mPos));
+      if ( !lt ) {
+        mPos = mEnd;
+        if ( !refill() ) {
+          return false;
+        }
+        continue;
+      }
+      mPos = lt - mData;
+
+      //make sure "<![CDATA[" would fit before deciding what this is
+      while ( mEnd - mPos < 9 && refill() ) {}
+      if ( mError != LTC_ERROR::OK ) {
+        return false;
+      }
+      const char* p = mData + mPos;
+      size_t available = mEnd - mPos;
+      if ( available < 2 ) {
+        mError = LTC_ERROR::XML_ERROR_PARSING_ELEMENT;
+        return false;
+      }
+
+      if ( p[1] == '?' ) {
+        if ( !skipPast("?>", 2, 2, LTC_ERROR::XML_ERROR_PARSING_DECLARATION) ) {
+          return false;
+        }
+        continue;
+      }
+      if ( p[1] == '!' ) {
+        bool ok;
+        if ( available >= 4 && strncmp(p, "<!--", 4) == 0 ) {
+          ok = skipPast("-->", 3, 4, LTC_ERROR::XML_ERROR_PARSING_COMMENT);
+        }
+        else if ( available >= 9 && strncmp(p, "<![CDATA[", 9) == 0 ) {
+          ok = skipPast("]]>", 3, 9, LTC_ERROR::XML_ERROR_PARSING_CDATA);
+        }
+        else {
+          ok = skipPast(">", 1, 2, LTC_ERROR::XML_ERROR_PARSING_UNKNOWN);
+        }
+        if ( !ok ) {
+          return false;
+        }
+        continue;
+      }
+
+      bool needMore;
+      if ( parseTag(tag, needMore) ) {
+        return true;
+      }
+      if ( !needMore ) {
+        return false;
+      }
+      if ( !refill() ) {
+        if ( mError == LTC_ERROR::OK ) {
+          mError = LTC_ERROR::XML_ERROR_PARSING_ELEMENT;
+        }
+        return false;
+      }
+    }
+  }
+
+  int LTCStreamReader::nodeAttributeSlot(const char* name, size_t length) {
+    if ( length == 1 ) {
+      switch ( name[0] ) {
+      case 'x': return 0;
+      case 'y': return 1;
+      case 'z': return 2;
+      case 'r': return 3;
+      default: return -1;
+      }
+    }
+    if ( length == 2 && (name[1] == 's' || name[1] == 'e') ) {
+      int offset = name[1] == 's' ? 4 : 7;
+      switch ( name[0] ) {
+      case 'x': return offset;
+      case 'y': return offset + 1;
+      case 'z': return offset + 2;
+      default: return -1;
+      }
+    }
+    return -1;
+  }
+
+  LTCUnits LTCStreamReader::parseUnits(const LTCXmlAttribute* attribute) {
+    if ( attribute ) {
+      if ( attribute->valueIs("m") ) {
+        return LTCUnits::M;
+      }
+      else if ( attribute->valueIs("cm") ) {
+        return LTCUnits::CM;
+      }
+      else if ( attribute->valueIs("in") ) {
+        return LTCUnits::IN;
+      }
+      else if ( attribute->valueIs("ft") ) {
+        return LTCUnits::FT;
+      }
+    }
+    return LTCUnits::MM;
+  }
+
+  std::string LTCStreamReader::decodeValue(const LTCXmlAttribute& attribute) {
+    //Same entity & newline handling as tinyxml2 applies to attribute values
+    std::string out;
+    out.reserve(attribute.mValueLength);
+    const char* p = attribute.mValue;
+    const char* end = p + attribute.mValueLength;
+    while ( p < end ) {
+      if ( *p == '\r' ) {
+        out += '\n';
+        p += (p + 1 < end && p[1] == '\n') ? 2 : 1;
+      }
+      else if ( *p == '\n' ) {
+        out += '\n';
+        p += (p + 1 < end && p[1] == '\r') ? 2 : 1;
+      }
+      else if ( *p == '&' ) {
+        auto semi = static_cast<const char*>(memchr(p, ';', end - p));
+        if ( !semi ) {
+          out += *p++;
+          continue;
+        }
+        std::string entity(p + 1, semi);
+        if ( entity == "quot" ) {
+          out += '\"';
+        }
+        else if ( entity == "amp" ) {
+          out += '&';
+        }
+        else if ( entity == "apos" ) {
+          out += '\'';
+        }
+        else if ( entity == "lt" ) {
+          out += '<';
+        }
+        else if ( entity == "gt" ) {
+          out += '>';
+        }
+        else if ( entity.size() > 1 && entity[0] == '#' ) {
+          bool hex = entity[1] == 'x';
+          char* last;
+          unsigned long ucs = strtoul(entity.c_str() + (hex ? 2 : 1), &last, hex ? 16 : 10);
+          if ( *last != 0 ) {
+            out += *p++;
+            continue;
+          }
+          appendUTF8(ucs, out);
+        }
+        else {
+          out += *p++;
+          continue;
+        }
+        p = semi + 1;
+      }
+      else {
+        out += *p++;
+      }
+    }
+    return out;
+  }
+
+  LTC_ERROR LTCStreamReader::skipElement() {
+    int depth = 1;
+    while ( depth > 0 ) {
+      if ( !mScanner.next(mTag) ) {
+        auto err = mScanner.getError();
+        return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+      }
+      if ( mTag.mKind == LTCXmlTag::START ) {
+        depth++;
+      }
+      else if ( mTag.mKind == LTCXmlTag::END ) {
+        depth--;
+      }
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::read(std::vector<LTCGraphP>& graphs) {
+    bool foundElement = false;
+    bool foundGraph = false;
+    while ( mScanner.next(mTag) ) {
+      foundElement = true;
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+      }
+      if ( !mTag.is("graph") ) {
+        if ( mTag.mKind == LTCXmlTag::START ) {
+          auto err = skipElement();
+          if ( err != LTC_ERROR::OK ) {
+            return err;
+          }
+        }
+        continue;
+      }
+
+      foundGraph = true;
+      LTCGraphP graph;
+      auto err = readGraph(mTag, graph);
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+      if ( graph ) {
+        graphs.push_back(graph);
+      }
+    }
+    if ( mScanner.getError() != LTC_ERROR::OK ) {
+      return mScanner.getError();
+    }
+    if ( !foundElement ) {
+      return LTC_ERROR::XML_ERROR_EMPTY_DOCUMENT;
+    }
+    if ( !foundGraph ) {
+      return LTC_ERROR::LTC_NO_LATTICE;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::scan(std::vector<LTCGraphInfo>& infos) {
+    bool foundElement = false;
+    bool foundGraph = false;
+    while ( mScanner.next(mTag) ) {
+      foundElement = true;
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+      }
+      if ( !mTag.is("graph") ) {
+        if ( mTag.mKind == LTCXmlTag::START ) {
+          auto err = skipElement();
+          if ( err != LTC_ERROR::OK ) {
+            return err;
+          }
+        }
+        continue;
+      }
+
+      foundGraph = true;
+      LTCGraphInfo info;
+      auto err = scanGraph(mTag, info);
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+      infos.push_back(info);
+    }
+    if ( mScanner.getError() != LTC_ERROR::OK ) {
+      return mScanner.getError();
+    }
+    if ( !foundElement ) {
+      return LTC_ERROR::XML_ERROR_EMPTY_DOCUMENT;
+    }
+    if ( !foundGraph ) {
+      return LTC_ERROR::LTC_NO_LATTICE;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::scanGraph(const LTCXmlTag& graphTag, LTCGraphInfo& info) {
+    auto idAttribute = graphTag.find("id");
+    if ( !idAttribute ) {
+      return LTC_ERROR::XML_NO_ATTRIBUTE;
+    }
+    if ( !toInt(*idAttribute, info.mID) ) {
+      return LTC_ERROR::XML_WRONG_ATTRIBUTE_TYPE;
+    }
+    auto nameAttribute = graphTag.find("name");
+    if ( nameAttribute ) {
+      info.mName = decodeValue(*nameAttribute);
+    }
+    info.mUnits = parseUnits(graphTag.find("units"));
+    auto typeAttribute = graphTag.find("type");
+    if ( !typeAttribute || typeAttribute->valueIs("rnd") ) {
+      info.mType = LTCModel::ROUND;
+    }
+    else if ( typeAttribute->valueIs("rib") ) {
+      info.mType = LTCModel::RIB;
+    }
+    else {
+      info.mType = LTCModel::UNDEFINED;
+    }
+
+    //graphTag aliases mTag, nothing may be read from it past this point
+    if ( graphTag.mKind != LTCXmlTag::START ) {
+      return LTC_ERROR::OK;
+    }
+    //the same groups readGraph would read
+    bool hasNodes = false;
+    bool hasBeams = false;
+    bool hasFaces = false;
+    while ( true ) {
+      if ( !mScanner.next(mTag) ) {
+        auto err = mScanner.getError();
+        return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+      }
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        if ( !mTag.is("graph") ) {
+          return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+        }
+        return LTC_ERROR::OK;
+      }
+      bool isStart = mTag.mKind == LTCXmlTag::START;
+      auto err = LTC_ERROR::OK;
+      if ( !hasNodes && mTag.is("nodegroup") ) {
+        hasNodes = true;
+        if ( isStart ) {
+          err = countElements("nodegroup", "node", info.mNumOfNodes);
+        }
+      }
+      else if ( hasNodes && !hasBeams && mTag.is("beamgroup") ) {
+        hasBeams = true;
+        if ( isStart ) {
+          err = countElements("beamgroup", "beam", info.mNumOfBeams);
+        }
+      }
+      else if ( hasNodes && !hasFaces && mTag.is("facegroup") ) {
+        hasFaces = true;
+        if ( isStart ) {
+          err = countElements("facegroup", "face", info.mNumOfFaces);
+        }
+      }
+      else if ( isStart ) {
+        err = skipElement();
+      }
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+    }
+  }
+
+  LTC_ERROR LTCStreamReader::countElements(const char* groupName, const char* elementName,
+                                           size_t& count) {
+    count = 0;
+    mScanner.setSkipAttributes(true);
+    auto err = countGroupElements(groupName, elementName, count);
+    mScanner.setSkipAttributes(false);
+    return err;
+  }
+
+  LTC_ERROR LTCStreamReader::countGroupElements(const char* groupName, const char* elementName,
+                                                size_t& count) {
+    while ( true ) {
+      if ( !mScanner.next(mTag) ) {
+        auto err = mScanner.getError();
+        return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+      }
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        if ( !mTag.is(groupName) ) {
+          return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+        }
+        return LTC_ERROR::OK;
+      }
+      if ( mTag.is(elementName) ) {
+        count++;
+      }
+      if ( mTag.mKind == LTCXmlTag::START ) {
+        auto err = skipElement();
+        if ( err != LTC_ERROR::OK ) {
+          return err;
+        }
+      }
+    }
+  }
+
+  LTC_ERROR LTCStreamReader::readGraph(const LTCXmlTag& graphTag, LTCGraphP& graph) {
+    graph = nullptr;
+
+    int id;
+    auto idAttribute = graphTag.find("id"); //get lattice id
+    if ( !idAttribute ) {
+      return LTC_ERROR::XML_NO_ATTRIBUTE;
+    }
+    if ( !toInt(*idAttribute, id) ) {
+      return LTC_ERROR::XML_WRONG_ATTRIBUTE_TYPE;
+    }
+
+    std::string name = "no_name";
+    auto nameAttribute = graphTag.find("name"); //get lattice name
+    if ( nameAttribute ) {
+      name = decodeValue(*nameAttribute);
+    }
+    auto gUnits = parseUnits(graphTag.find("units"));
+    //nodes go in raw & get one vectorized unit conversion once read;
+    //float32 graphs have to round after converting, so they use addNode's
+    bool convertAfterRead = gUnits != LTCUnits::MM &&
+      mNodePrecision == LTCNodePrecision::FLOAT64;
+    auto newGraph = LTCGraph::create(name, id, convertAfterRead ? LTCUnits::MM : gUnits);
+    newGraph->setNodeStorage(mNodeStorage);
+    newGraph->setNodePrecision(mNodePrecision);
+
+    //graphTag aliases mTag, nothing may be read from it past this point
+    if ( graphTag.mKind == LTCXmlTag::START ) {
+      bool hasNodes = false;
+      bool hasBeams = false;
+      bool hasFaces = false;
+      while ( true ) {
+        if ( !mScanner.next(mTag) ) {
+          auto err = mScanner.getError();
+          return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+        }
+        if ( mTag.mKind == LTCXmlTag::END ) {
+          if ( !mTag.is("graph") ) {
+            return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+          }
+          break;
+        }
+
+        bool isStart = mTag.mKind == LTCXmlTag::START;
+        auto err = LTC_ERROR::OK;
+        if ( !hasNodes && mTag.is("nodegroup") ) {
+          hasNodes = true;
+          if ( !isStart ) {
+            return LTC_ERROR::LTC_NO_NODES;
+          }
+          err = readNodes(*newGraph);
+          if ( err == LTC_ERROR::OK && convertAfterRead ) {
+            newGraph->setUnits(gUnits);
+            newGraph->scaleNodes(LTCGraph::getUnitScale(gUnits));
+          }
+        }
+        //beams & faces only count after the nodegroup, like readFromXml
+        else if ( hasNodes && !hasBeams && mTag.is("beamgroup") ) {
+          hasBeams = true;
+          if ( !isStart ) {
+            return LTC_ERROR::LTC_NO_BEAMS;
+          }
+          err = readBeams(*newGraph);
+        }
+        else if ( hasNodes && !hasFaces && mTag.is("facegroup") ) {
+          hasFaces = true;
+          if ( isStart ) {
+            err = readFaces(*newGraph);
+          }
+        }
+        else if ( isStart ) {
+          err = skipElement();
+        }
+        if ( err != LTC_ERROR::OK ) {
+          return err;
+        }
+      }
+    }
+
+    if ( newGraph->getNodeCount() == 0 ) {
+      return LTC_ERROR::LTC_NO_NODES;
+    }
+    if ( !newGraph->getFaces().empty() || !newGraph->getBeams().empty() ) {
+      graph = newGraph;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::readNodes(LTCGraph& graph) {
+    auto err = readGroup("nodegroup", &LTCStreamReader::readNodeElements, graph);
+    if ( err == LTC_ERROR::OK && graph.getNodeCount() == 0 ) {
+      return LTC_ERROR::LTC_NO_NODES;
+    }
+    return err;
+  }
+
+  LTC_ERROR LTCStreamReader::readBeams(LTCGraph& graph) {
+    size_t numOfBeams = graph.getBeams().size();
+    auto err = readGroup("beamgroup", &LTCStreamReader::readBeamElements, graph);
+    if ( err == LTC_ERROR::OK && graph.getBeams().size() == numOfBeams ) {
+      return LTC_ERROR::LTC_NO_BEAMS;
+    }
+    return err;
+  }
+
+  LTC_ERROR LTCStreamReader::readFaces(LTCGraph& graph) {
+    return readGroup("facegroup", &LTCStreamReader::readFaceElements, graph);
+  }
+
+  LTC_ERROR LTCStreamReader::readGroup(const char* groupName, ReadElements readElements,
+                                       LTCGraph& graph) {
+    unsigned int numOfThreads = resolveThreadCount(mNumOfThreads);
+    std::vector<LTCTextRange> chunks;
+    size_t groupEnd = 0;
+    if ( numOfThreads == 1 || !mScanner.isInMemory() ||
+        !LTCParallelReader::splitGroup(mScanner.getData(), mScanner.getSize(),
+                                       mScanner.getPosition(), groupName, mChunkSize,
+                                       size_t(numOfThreads) * 4, chunks, groupEnd) ||
+        chunks.size() < 2 ) {
+      //malformed groups are read sequentially too, so errors match
+      return (this->*readElements)(graph, groupName);
+    }
+
+    //every chunk fills its own graph, they are stitched back in order
+    const char* data = mScanner.getData();
+    std::vector<LTCGraphP> parts(chunks.size());
+    std::vector<LTC_ERROR> errors(chunks.size(), LTC_ERROR::OK);
+    parallelFor(chunks.size(), numOfThreads, [&](size_t i) {
+      LTCXmlScanner scanner(data + chunks[i].mBegin, chunks[i].mEnd - chunks[i].mBegin);
+      LTCStreamReader reader(scanner, graph.getNodeStorage(), graph.getNodePrecision());
+      parts[i] = LTCGraph::create(graph.getName(), graph.getID(), graph.getUnits());
+      parts[i]->setNodeStorage(graph.getNodeStorage());
+      parts[i]->setNodePrecision(graph.getNodePrecision());
+      errors[i] = (reader.*readElements)(*parts[i], nullptr);
+    });
+    for ( auto err : errors ) {
+      if ( err != LTC_ERROR::OK ) {
+        return err;
+      }
+    }
+    appendParts(graph, parts);
+    mScanner.setPosition(groupEnd);
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::readNodeElements(LTCGraph& graph, const char* groupName) {
+    while ( true ) {
+      if ( !mScanner.next(mTag) ) {
+        auto err = mScanner.getError();
+        if ( err == LTC_ERROR::OK && !groupName ) {
+          break; //end of a chunk
+        }
+        return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+      }
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        if ( !groupName || !mTag.is(groupName) ) {
+          return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+        }
+        break;
+      }
+      if ( mTag.is("node") ) {
+        // x y z r xs ys zs xe ye ze
+        double v[10] = { 0.0, 0.0, 0.0, -1.0, -1, -1, -1, -1, -1, -1 };
+
+        //one pass over the attributes instead of a lookup per value
+        for ( auto& attribute : mTag.mAttributes ) {
+          int slot = nodeAttributeSlot(attribute.mName, attribute.mNameLength);
+          if ( slot >= 0 ) {
+            toDouble(attribute, v[slot]);
+          }
+        }
+
+        if ( v[4] != v[7] ||
+            v[5] != v[8] ||
+            v[6] != v[9] ) {
+          graph.addNode(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9]);
+        }
+        else {
+          graph.addNode(v[0], v[1], v[2], v[3]);
+        }
+      }
+      if ( mTag.mKind == LTCXmlTag::START ) {
+        auto err = skipElement();
+        if ( err != LTC_ERROR::OK ) {
+          return err;
+        }
+      }
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::readBeamElements(LTCGraph& graph, const char* groupName) {
+    while ( true ) {
+      if ( !mScanner.next(mTag) ) {
+        auto err = mScanner.getError();
+        if ( err == LTC_ERROR::OK && !groupName ) {
+          break; //end of a chunk
+        }
+        return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+      }
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        if ( !groupName || !mTag.is(groupName) ) {
+          return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+        }
+        break;
+      }
+      if ( mTag.is("beam") ) {
+        int n1 = 0, n2 = 0;
+        for ( auto& attribute : mTag.mAttributes ) {
+          if ( attribute.is("n1") ) {
+            toInt(attribute, n1);
+          }
+          else if ( attribute.is("n2") ) {
+            toInt(attribute, n2);
+          }
+        }
+        graph.addBeam(n1, n2);
+      }
+      if ( mTag.mKind == LTCXmlTag::START ) {
+        auto err = skipElement();
+        if ( err != LTC_ERROR::OK ) {
+          return err;
+        }
+      }
+    }
+    return LTC_ERROR::OK;
+  }
+
+  LTC_ERROR LTCStreamReader::readFaceElements(LTCGraph& graph, const char* groupName) {
+    while ( true ) {
+      if ( !mScanner.next(mTag) ) {
+        auto err = mScanner.getError();
+        if ( err == LTC_ERROR::OK && !groupName ) {
+          break; //end of a chunk
+        }
+        return err != LTC_ERROR::OK ? err : LTC_ERROR::XML_ERROR_PARSING;
+      }
+      if ( mTag.mKind == LTCXmlTag::END ) {
+        if ( !groupName || !mTag.is(groupName) ) {
+          return LTC_ERROR::XML_ERROR_MISMATCHED_ELEMENT;
+        }
+        break;
+      }
+      if ( mTag.is("face") ) {
+        // set n4 too -1 in case it can't be loaded, remember, it is optional!
+        int n1 = 0, n2 = 0, n3 = 0, n4 = -1;
+        for ( auto& attribute : mTag.mAttributes ) {
+          if ( attribute.is("n1") ) {
+            toInt(attribute, n1);
+          }
+          else if ( attribute.is("n2") ) {
+            toInt(attribute, n2);
+          }
+          else if ( attribute.is("n3") ) {
+            toInt(attribute, n3);
+          }
+          else if ( attribute.is("n4") ) {
+            toInt(attribute, n4);
+          }
+        }
+        graph.addFace(n1, n2, n3, n4);
+      }
+      if ( mTag.mKind == LTCXmlTag::START ) {
+        auto err = skipElement();
+        if ( err != LTC_ERROR::OK ) {
+          return err;
+        }
+      }
+    }
+    return LTC_ERROR::OK;
+  }
+
+}//namespace LTC
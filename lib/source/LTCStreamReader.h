@@ -0,0 +1,202 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCModel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCXmlAttribute
+  /*!
+  A single attribute of a tag. Name & value point into the scanner's buffer
+  and are only valid until the next call to LTCXmlScanner::next().
+  The value is raw, entities are not expanded.
+  */
+  struct LTCXmlAttribute {
+    const char* mName;
+    size_t mNameLength;
+    const char* mValue;
+    size_t mValueLength;
+
+    bool is(const char* name)const;
+    bool valueIs(const char* value)const;
+  };
+
+  //! LTCXmlTag
+  /*!
+  A start, end or empty-element tag as returned by LTCXmlScanner.
+  */
+  struct LTCXmlTag {
+    enum Kind {
+      START = 0, // <name ...>
+      END = 1,   // </name>
+      EMPTY = 2  // <name .../>
+    };
+
+    Kind mKind;
+    const char* mName;
+    size_t mNameLength;
+    std::vector<LTCXmlAttribute> mAttributes;
+
+    bool is(const char* name)const;
+    const LTCXmlAttribute* find(const char* name)const;
+  };
+
+  //! LTCXmlScanner
+  /*!
+  Forward-only XML tokenizer. It returns tags one at a time from either an
+  in-memory buffer or a FILE* that is read in fixed size chunks, so no
+  document tree is ever built. Text, comments, declarations & CDATA are
+  skipped.
+  */
+  class LTCXmlScanner {
+  public:
+    LTCXmlScanner(const char* text, size_t numOfBytes);
+    LTCXmlScanner(FILE* file, size_t chunkSize = 1 << 20);
+
+    //! Reads the next tag. Returns false at the end of input or on error.
+    bool next(LTCXmlTag& tag);
+
+    LTC_ERROR getError()const { return mError; }
+
+    //! Tags come back without attributes, they are skipped & not checked.
+    void setSkipAttributes(bool skip) { mSkipAttributes = skip; }
+
+    //! In-memory scanners can be repositioned, e.g. past a group read in parallel.
+    bool isInMemory()const { return mFile == nullptr; }
+    const char* getData()const { return mData; }
+    size_t getSize()const { return mEnd; }
+    size_t getPosition()const { return mPos; }
+    void setPosition(size_t pos) { mPos = pos; }
+
+  private:
+    bool refill();
+    bool skipPast(const char* terminator, size_t length, size_t offset,
+                  LTC_ERROR error);
+    bool parseTag(LTCXmlTag& tag, bool& needMore);
+
+    FILE* mFile;
+    std::vector<char> mBuffer;
+    const char* mData;
+    size_t mPos;
+    size_t mEnd;
+    bool mEof;
+    bool mSkipAttributes;
+    LTC_ERROR mError;
+  };
+
+  //! LTCStreamReader
+  /*!
+  Builds LTCGraphs directly from an LTCXmlScanner in one forward pass,
+  following the same rules as LTCModel::readFromXml for well formed
+  documents, except:
+  - a missing node or beam attribute reads as 0 (x, y, z, n1, n2) or -1
+    (r & orientation); readFromXml keeps the previous element's value.
+  - a duplicate attribute is not an error, the last one wins; tinyxml2
+    rejects the document with XML_ERROR_PARSING_ATTRIBUTE.
+  - graphs completed before an XML error (e.g. junk after the last
+    graph) stay appended, readFromXml never starts on a document that
+    does not parse. Errors found while reading a graph (LTC_NO_NODES,
+    ...) leave the graphs before it appended in both.
+  */
+  class LTCStreamReader {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    LTCStreamReader(LTCXmlScanner& scanner,
+                    LTCNodeStorage storage = LTCNodeStorage::AOS,
+                    LTCNodePrecision precision = LTCNodePrecision::FLOAT64) :
+      mScanner(scanner),
+      mNodeStorage(storage),
+      mNodePrecision(precision),
+      mNumOfThreads(1),
+      mChunkSize(1 << 20) {}
+
+    //! Reads large groups on several threads, in-memory scanners only.
+    /*!
+    A nodegroup, beamgroup or facegroup is split into chunks of at least
+    chunkSize bytes at element boundaries, the chunks are parsed on up to
+    numOfThreads threads (0 = hardware threads) & stitched back in document
+    order, so the graph is the same as one read on a single thread. Groups
+    that are too small or not well formed are read sequentially.
+    */
+    void setNumOfThreads(unsigned int numOfThreads, size_t chunkSize = 1 << 20) {
+      mNumOfThreads = numOfThreads;
+      mChunkSize = std::max<size_t>(chunkSize, 1);
+    }
+
+    //! Reads every top level <graph>, graphs are appended as they complete.
+    LTC_ERROR read(std::vector<LTCGraphP>& graphs);
+
+    //! Reads the body of a graph whose start tag was just returned.
+    /*!
+    graph is set to nullptr if the graph has neither beams nor faces.
+    */
+    LTC_ERROR readGraph(const LTCXmlTag& graphTag, LTCGraphP& graph);
+
+    //! Lists every top level <graph> without reading nodes, beams or faces.
+    LTC_ERROR scan(std::vector<LTCGraphInfo>& infos);
+
+    //! Slot of a node attribute in { x, y, z, r, xs, ys, zs, xe, ye, ze }, or -1.
+    static int nodeAttributeSlot(const char* name, size_t length);
+
+    static LTCUnits parseUnits(const LTCXmlAttribute* attribute);
+    static std::string decodeValue(const LTCXmlAttribute& attribute);
+
+  private:
+    LTC_ERROR readNodes(LTCGraph& graph);
+    LTC_ERROR readBeams(LTCGraph& graph);
+    LTC_ERROR readFaces(LTCGraph& graph);
+
+    //! Reads the elements of a group, or of a chunk of one if groupName is nullptr.
+    typedef LTC_ERROR (LTCStreamReader::*ReadElements)(LTCGraph& graph, const char* groupName);
+    LTC_ERROR readGroup(const char* groupName, ReadElements readElements, LTCGraph& graph);
+    LTC_ERROR readNodeElements(LTCGraph& graph, const char* groupName);
+    LTC_ERROR readBeamElements(LTCGraph& graph, const char* groupName);
+    LTC_ERROR readFaceElements(LTCGraph& graph, const char* groupName);
+    LTC_ERROR skipElement();
+
+    LTC_ERROR scanGraph(const LTCXmlTag& graphTag, LTCGraphInfo& info);
+    //! Counts the elementName children of the group whose start tag was just read.
+    LTC_ERROR countElements(const char* groupName, const char* elementName, size_t& count);
+    LTC_ERROR countGroupElements(const char* groupName, const char* elementName, size_t& count);
+
+    LTCXmlScanner& mScanner;
+    LTCNodeStorage mNodeStorage;
+    LTCNodePrecision mNodePrecision;
+    unsigned int mNumOfThreads;
+    size_t mChunkSize;
+    LTCXmlTag mTag;
+  };
+
+}//namespace LTC
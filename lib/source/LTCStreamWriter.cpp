@@ -0,0 +1,313 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCStreamWriter.h"
+#include "LTCNumber.h"
+#include "LTCParallel.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace LTC {
+
+  namespace {
+    //Matches tinyxml2's XMLUtil::ToStr(int)
+    void appendInt(std::string& out, int value) {
+      char digits[16];
+      int length = 0;
+      unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value)
+                                         : static_cast<unsigned int>(value);
+      do {
+        digits[length++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+      } while ( magnitude );
+      if ( value < 0 ) {
+        out += '-';
+      }
+      while ( length ) {
+        out += digits[--length];
+      }
+    }
+
+    void appendAttribute(std::string& out, const char* name, int value) {
+      out += ' ';
+      out += name;
+      out += "=\"";
+      appendInt(out, value);
+      out += '\"';
+    }
+
+    void appendAttribute(std::string& out, const char* name, double value,
+                         const LTCWriteOptions& options,
+                         LTCNodePrecision precision) {
+      out += ' ';
+      out += name;
+      out += "=\"";
+      LTCStreamWriter::appendDouble(out, value, options, precision);
+      out += '\"';
+    }
+
+    bool isOriented(const Node& n) {
+      return n.mXS != n.mXE ||
+        n.mYS != n.mYE ||
+        n.mZS != n.mZE;
+    }
+
+    const char* unitsName(LTCUnits units) {
+      switch ( units ) {
+      case LTCUnits::MM: return "mm";
+      case LTCUnits::CM: return "cm";
+      case LTCUnits::M: return "m";
+      case LTCUnits::FT: return "ft";
+      case LTCUnits::IN: return "in";
+      }
+      return nullptr;
+    }
+  }
+
+  LTCStreamWriter::LTCStreamWriter(FILE* file,
+                                   const LTCWriteOptions& options,
+                                   size_t bufferSize) :
+    mFile(file),
+    mOptions(options),
+    mBufferSize(bufferSize),
+    mNumOfThreads(1),
+    mFailed(false) {
+    mBuffer.reserve(bufferSize + 512);
+  }
+
+  void LTCStreamWriter::appendEscaped(std::string& out, const char* text) {
+    //Matches XMLPrinter::PrintString for attribute values
+    for ( const char* p = text; *p; ++p ) {
+      switch ( *p ) {
+      case '\"': out += "&quot;"; break;
+      case '&': out += "&amp;"; break;
+      case '\'': out += "&apos;"; break;
+      case '<': out += "&lt;"; break;
+      case '>': out += "&gt;"; break;
+      default: out += *p; break;
+      }
+    }
+  }
+
+  void LTCStreamWriter::appendDouble(std::string& out, double value,
+                                     const LTCWriteOptions& options,
+                                     LTCNodePrecision precision) {
+    char buffer[40];
+    int length;
+    int maxDigits = options.mMaxSignificantDigits;
+    bool isFloat = precision == LTCNodePrecision::FLOAT32;
+    if ( options.mFloatFormat == LTCFloatFormat::SHORTEST ) {
+      if ( isFloat ) {
+        length = formatPrecision(static_cast<float>(value), maxDigits, buffer);
+      }
+      else {
+        length = formatPrecision(value, maxDigits, buffer);
+      }
+    }
+    else {
+      //Matches tinyxml2's XMLUtil::ToStr(double), 9 digits round trip a float
+      int exactDigits = isFloat ? 9 : 17;
+      if ( maxDigits <= 0 || maxDigits > exactDigits ) {
+        maxDigits = exactDigits;
+      }
+      length = snprintf(buffer, sizeof(buffer), "%.*g", maxDigits, value);
+    }
+    out.append(buffer, length);
+  }
+
+  void LTCStreamWriter::appendNode(std::string& out, const Node& n, int id,
+                                   const LTCWriteOptions& options,
+                                   LTCNodePrecision precision) {
+    out += "\n        <node";
+    appendAttribute(out, "id", id);
+    appendAttribute(out, "x", n.mX, options, precision);
+    appendAttribute(out, "y", n.mY, options, precision);
+    appendAttribute(out, "z", n.mZ, options, precision);
+    if ( n.mRadius > 0.0 ) {
+      appendAttribute(out, "r", n.mRadius, options, precision);
+    }
+
+    //If node has orientation data, write it:
+    if ( isOriented(n) ) {
+      appendAttribute(out, "xs", n.mXS, options, precision);
+      appendAttribute(out, "ys", n.mYS, options, precision);
+      appendAttribute(out, "zs", n.mZS, options, precision);
+
+      appendAttribute(out, "xe", n.mXE, options, precision);
+      appendAttribute(out, "ye", n.mYE, options, precision);
+      appendAttribute(out, "ze", n.mZE, options, precision);
+    }
+    out += "/>";
+  }
+
+  void LTCStreamWriter::appendBeam(std::string& out, const Beam& b, int id) {
+    out += "\n        <beam";
+    appendAttribute(out, "id", id);
+    appendAttribute(out, "n1", b.mNode1Idx);
+    appendAttribute(out, "n2", b.mNode2Idx);
+    out += "/>";
+  }
+
+  void LTCStreamWriter::appendFace(std::string& out, const Face& f, int id) {
+    out += "\n        <face";
+    appendAttribute(out, "id", id);
+    appendAttribute(out, "n1", f.v0);
+    appendAttribute(out, "n2", f.v1);
+    appendAttribute(out, "n3", f.v2);
+    if ( f.v3 != -1 ) { //only insert quad element, if face is a quad.
+      appendAttribute(out, "n4", f.v3);
+    }
+    out += "/>";
+  }
+
+  void LTCStreamWriter::append(const char* text) {
+    mBuffer += text;
+  }
+
+  void LTCStreamWriter::flushIfFull() {
+    if ( mBuffer.size() >= mBufferSize ) {
+      flush();
+    }
+  }
+
+  template <typename AppendElement>
+  void LTCStreamWriter::writeElements(size_t count, AppendElement appendElement) {
+    unsigned int numOfThreads = resolveThreadCount(mNumOfThreads);
+    if ( numOfThreads == 1 ) {
+      for ( size_t i = 0; i < count; i++ ) {
+        appendElement(mBuffer, i);
+        flushIfFull();
+      }
+      return;
+    }
+
+    //blocks of elements are formatted a batch at a time, then written in order
+    const size_t blockSize = 1 << 14;
+    std::vector<std::string> blocks(size_t(numOfThreads) * 4);
+    for ( size_t first = 0; first < count && !mFailed; ) {
+      size_t numOfBlocks = std::min(blocks.size(), (count - first + blockSize - 1) / blockSize);
+      parallelFor(numOfBlocks, numOfThreads, [&](size_t b) {
+        size_t begin = first + b * blockSize;
+        size_t end = std::min(begin + blockSize, count);
+        auto& block = blocks[b];
+        block.clear();
+        for ( size_t i = begin; i < end; i++ ) {
+          appendElement(block, i);
+        }
+      });
+      flush();
+      for ( size_t b = 0; b < numOfBlocks && !mFailed; b++ ) {
+        if ( fwrite(blocks[b].data(), 1, blocks[b].size(), mFile) != blocks[b].size() ) {
+          mFailed = true;
+        }
+      }
+      first = std::min(first + numOfBlocks * blockSize, count);
+    }
+  }
+
+  void LTCStreamWriter::flush() {
+    if ( !mBuffer.empty() &&
+        fwrite(mBuffer.data(), 1, mBuffer.size(), mFile) != mBuffer.size() ) {
+      mFailed = true;
+    }
+    mBuffer.clear();
+  }
+
+  LTC_ERROR LTCStreamWriter::write(const std::vector<LTCGraphP>& graphs,
+                                   const std::string& comment) {
+    //Same sequence of calls XMLPrinter makes for writeToXml's document
+    append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+    append("\n<!--");
+    append(comment.c_str());
+    append("-->");
+    for ( auto& graph : graphs ) {
+      writeGraph(*graph);
+      if ( mFailed ) {
+        break;
+      }
+    }
+    flush();
+    return mFailed ? LTC_ERROR::LTC_FILE_WRITE_ERROR : LTC_ERROR::OK;
+  }
+
+  void LTCStreamWriter::writeGraph(const LTCGraph& graph) {
+    //nodes go through getNode so SoA graphs are not copied to AoS first
+    size_t numOfNodes = graph.getNodeCount();
+    auto precision = graph.getNodePrecision();
+    const auto& beams = graph.getBeams();
+    const auto& faces = graph.getFaces();
+
+    //the type attribute goes in the start tag, so look for orientation first
+    bool oriented = graph.isOriented();
+
+    append("\n<graph");
+    appendAttribute(mBuffer, "id", graph.getID());
+    append(" name=\"");
+    appendEscaped(mBuffer, graph.getName().c_str());
+    append("\"");
+    auto units = unitsName(graph.getUnits());
+    if ( units ) {
+      append(" units=\"");
+      append(units);
+      append("\"");
+    }
+    append(oriented ? " type=\"rib\">" : " type=\"rnd\">");
+
+    append("\n    <nodegroup");
+    if ( numOfNodes == 0 ) {
+      append("/>");
+    }
+    else {
+      append(">");
+      writeElements(numOfNodes, [&](std::string& out, size_t i) {
+        appendNode(out, graph.getNode(i), static_cast<int>(i), mOptions, precision);
+      });
+      append("\n    </nodegroup>");
+    }
+
+    if ( !beams.empty() ) {
+      append("\n    <beamgroup>");
+      writeElements(beams.size(), [&](std::string& out, size_t i) {
+        appendBeam(out, beams[i], static_cast<int>(i));
+      });
+      append("\n    </beamgroup>");
+    }
+
+    if ( !faces.empty() ) {
+      append("\n    <facegroup>");
+      writeElements(faces.size(), [&](std::string& out, size_t i) {
+        appendFace(out, faces[i], static_cast<int>(i));
+      });
+      append("\n    </facegroup>");
+    }
+
+    append("\n</graph>\n");
+    flushIfFull();
+  }
+
+}//namespace LTC
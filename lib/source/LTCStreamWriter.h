@@ -0,0 +1,96 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCGraph.h"
+#include "LTCModel.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! LTCStreamWriter
+  /*!
+  Writes .ltcx text straight to a FILE* through a fixed size buffer, in a
+  single pass & without building an XMLDocument. The output is byte for
+  byte what LTCModel::writeToFile (tinyxml2's printer) produces, unless
+  LTCWriteOptions asks for a different float format.
+  */
+  class LTCStreamWriter {
+    typedef std::shared_ptr<LTCGraph> LTCGraphP;
+  public:
+    LTCStreamWriter(FILE* file,
+                    const LTCWriteOptions& options = LTCWriteOptions(),
+                    size_t bufferSize = 1 << 20);
+
+    LTC_ERROR write(const std::vector<LTCGraphP>& graphs,
+                    const std::string& comment);
+
+    //! Formats elements on numOfThreads threads (0 = hardware threads).
+    /*!
+    Each thread formats a contiguous block of nodes, beams or faces into its
+    own buffer & the buffers are written in order, so the output is the same
+    as on one thread. Only a few blocks per thread are held at a time.
+    */
+    void setNumOfThreads(unsigned int numOfThreads) { mNumOfThreads = numOfThreads; }
+
+    //Element formatters, each appends one complete element line to out.
+    static void appendNode(std::string& out, const Node& node, int id,
+                           const LTCWriteOptions& options = LTCWriteOptions(),
+                           LTCNodePrecision precision = LTCNodePrecision::FLOAT64);
+    static void appendBeam(std::string& out, const Beam& beam, int id);
+    static void appendFace(std::string& out, const Face& face, int id);
+
+    //Attribute value escaping, as XMLPrinter::PrintString does it.
+    static void appendEscaped(std::string& out, const char* text);
+
+    //One value in the given format, no quotes. FLOAT32 values are written
+    //with the digits a float needs ("%.9g" or float shortest).
+    static void appendDouble(std::string& out, double value,
+                             const LTCWriteOptions& options,
+                             LTCNodePrecision precision = LTCNodePrecision::FLOAT64);
+
+  private:
+    void writeGraph(const LTCGraph& graph);
+    template <typename AppendElement>
+    void writeElements(size_t count, AppendElement appendElement);
+    void append(const char* text);
+    void flushIfFull();
+    void flush();
+
+    FILE* mFile;
+    LTCWriteOptions mOptions;
+    std::string mBuffer;
+    size_t mBufferSize;
+    unsigned int mNumOfThreads;
+    bool mFailed;
+  };
+
+}//namespace LTC
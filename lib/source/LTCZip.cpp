@@ -0,0 +1,631 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "LTCZip.h"
+#include "LTCFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace LTC {
+
+  namespace {
+    const uint32_t kLocalHeaderSignature = 0x04034b50;
+    const uint32_t kCentralHeaderSignature = 0x02014b50;
+    const uint32_t kEndSignature = 0x06054b50;
+    const size_t kLocalHeaderSize = 30;
+    const size_t kCentralHeaderSize = 46;
+    const size_t kEndSize = 22;
+    const uint16_t kVersion = 20;       //2.0, deflate & folders
+    const uint16_t kUtf8Flag = 1 << 11; //names are UTF-8
+    const uint16_t kDosDate = 0x21;     //1980-01-01, time 00:00:00
+    const uint64_t kMaxSize = 0xffffffffu;
+
+    void putU16(unsigned char* p, uint16_t v) {
+      p[0] = static_cast<unsigned char>(v);
+      p[1] = static_cast<unsigned char>(v >> 8);
+    }
+
+    void putU32(unsigned char* p, uint32_t v) {
+      p[0] = static_cast<unsigned char>(v);
+      p[1] = static_cast<unsigned char>(v >> 8);
+      p[2] = static_cast<unsigned char>(v >> 16);
+      p[3] = static_cast<unsigned char>(v >> 24);
+    }
+
+    uint16_t getU16(const unsigned char* p) {
+      return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    uint32_t getU32(const unsigned char* p) {
+      return uint32_t(p[0]) | (uint32_t(p[1]) << 8) |
+        (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    struct CrcTable {
+      uint32_t mValues[256];
+
+      CrcTable() {
+        for ( uint32_t i = 0; i < 256; i++ ) {
+          uint32_t c = i;
+          for ( int k = 0; k < 8; k++ ) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+          }
+          mValues[i] = c;
+        }
+      }
+    };
+
+    //! Huffman
+    /*!
+    Canonical Huffman code as in zlib's puff: symbols sorted by code
+    length, plus a table indexed by the next kFastBits (bit reversed) input
+    bits for every code that short.
+    */
+    const int kMaxBits = 15;
+    const int kFastBits = 10;
+
+    struct Huffman {
+      uint16_t mCount[kMaxBits + 1];
+      uint16_t mSymbol[288];
+      uint16_t mFast[1 << kFastBits]; //symbol << 4 | length, 0 = not in table
+
+      //! False for over-subscribed codes, incomplete ones are allowed.
+      bool build(const uint8_t* lengths, int numOfSymbols) {
+        memset(mCount, 0, sizeof(mCount));
+        memset(mFast, 0, sizeof(mFast));
+        for ( int s = 0; s < numOfSymbols; s++ ) {
+          mCount[lengths[s]]++;
+        }
+        int left = 1;
+        for ( int len = 1; len <= kMaxBits; len++ ) {
+          left = (left << 1) - mCount[len];
+          if ( left < 0 ) {
+            return false;
+          }
+        }
+        uint16_t offsets[kMaxBits + 1];
+        uint16_t codes[kMaxBits + 1];
+        offsets[1] = 0;
+        codes[1] = 0;
+        for ( int len = 1; len < kMaxBits; len++ ) {
+          offsets[len + 1] = offsets[len] + mCount[len];
+          codes[len + 1] = static_cast<uint16_t>((codes[len] + mCount[len]) << 1);
+        }
+        for ( int s = 0; s < numOfSymbols; s++ ) {
+          int len = lengths[s];
+          if ( len == 0 ) {
+            continue;
+          }
+          mSymbol[offsets[len]++] = static_cast<uint16_t>(s);
+          int code = codes[len]++;
+          if ( len <= kFastBits ) {
+            //deflate packs codes from their top bit, the input is read from the bottom
+            int reversed = 0;
+            for ( int b = 0; b < len; b++ ) {
+              reversed |= ((code >> b) & 1) << (len - 1 - b);
+            }
+            for ( int fill = reversed; fill < (1 << kFastBits); fill += 1 << len ) {
+              mFast[fill] = static_cast<uint16_t>((s << 4) | len);
+            }
+          }
+        }
+        return true;
+      }
+    };
+
+    //! Inflater
+    /*!
+    RFC 1951 decoder over a memory buffer, bits are kept in a 64-bit
+    accumulator that is refilled a byte at a time.
+    */
+    class Inflater {
+    public:
+      Inflater(const unsigned char* data, size_t size, std::vector<char>& out) :
+        mData(data),
+        mSize(size),
+        mPos(0),
+        mBits(0),
+        mNumOfBits(0),
+        mOut(out),
+        mStart(out.size()) {}
+
+      bool run() {
+        int last;
+        do {
+          uint32_t header;
+          if ( !getBits(3, header) ) {
+            return false;
+          }
+          last = header & 1;
+          bool ok;
+          switch ( header >> 1 ) {
+          case 0: ok = stored(); break;
+          case 1: ok = fixed(); break;
+          case 2: ok = dynamic(); break;
+          default: ok = false; break;
+          }
+          if ( !ok ) {
+            return false;
+          }
+        } while ( !last );
+        return true;
+      }
+
+    private:
+      void refill() {
+        while ( mNumOfBits <= 56 && mPos < mSize ) {
+          mBits |= uint64_t(mData[mPos++]) << mNumOfBits;
+          mNumOfBits += 8;
+        }
+      }
+
+      bool getBits(int count, uint32_t& value) {
+        if ( mNumOfBits < unsigned(count) ) {
+          refill();
+          if ( mNumOfBits < unsigned(count) ) {
+            return false;
+          }
+        }
+        value = static_cast<uint32_t>(mBits & ((uint64_t(1) << count) - 1));
+        mBits >>= count;
+        mNumOfBits -= count;
+        return true;
+      }
+
+      //! Next symbol, -1 on a bad code or the end of input.
+      int decode(const Huffman& h) {
+        if ( mNumOfBits < unsigned(kMaxBits) ) {
+          refill();
+        }
+        uint16_t entry = h.mFast[mBits & ((1 << kFastBits) - 1)];
+        if ( entry && unsigned(entry & 15) <= mNumOfBits ) {
+          mBits >>= entry & 15;
+          mNumOfBits -= entry & 15;
+          return entry >> 4;
+        }
+        //longer codes, one bit at a time as in puff
+        int code = 0, first = 0, index = 0;
+        for ( int len = 1; len <= kMaxBits; len++ ) {
+          if ( mNumOfBits == 0 ) {
+            return -1;
+          }
+          code |= static_cast<int>(mBits & 1);
+          mBits >>= 1;
+          mNumOfBits--;
+          int count = h.mCount[len];
+          if ( code - count < first ) {
+            return h.mSymbol[index + (code - first)];
+          }
+          index += count;
+          first += count;
+          first <<= 1;
+          code <<= 1;
+        }
+        return -1;
+      }
+
+      bool stored() {
+        //drop to a byte boundary, whole bytes still buffered are given back
+        mBits >>= mNumOfBits & 7;
+        mNumOfBits -= mNumOfBits & 7;
+        mPos -= mNumOfBits / 8;
+        mBits = 0;
+        mNumOfBits = 0;
+        if ( mSize - mPos < 4 ) {
+          return false;
+        }
+        uint16_t len = getU16(mData + mPos);
+        if ( uint16_t(~getU16(mData + mPos + 2)) != len ) {
+          return false;
+        }
+        mPos += 4;
+        if ( mSize - mPos < len ) {
+          return false;
+        }
+        mOut.insert(mOut.end(), mData + mPos, mData + mPos + len);
+        mPos += len;
+        return true;
+      }
+
+      bool fixed() {
+        static const struct FixedCodes {
+          Huffman mLength, mDistance;
+          FixedCodes() {
+            uint8_t lengths[288];
+            int s = 0;
+            for ( ; s < 144; s++ ) lengths[s] = 8;
+            for ( ; s < 256; s++ ) lengths[s] = 9;
+            for ( ; s < 280; s++ ) lengths[s] = 7;
+            for ( ; s < 288; s++ ) lengths[s] = 8;
+            mLength.build(lengths, 288);
+            for ( s = 0; s < 30; s++ ) lengths[s] = 5;
+            mDistance.build(lengths, 30);
+          }
+        } kFixed;
+        return codes(kFixed.mLength, kFixed.mDistance);
+      }
+
+      bool dynamic() {
+        static const uint8_t kOrder[19] = {
+          16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+        uint32_t nlen, ndist, ncode;
+        if ( !getBits(5, nlen) || !getBits(5, ndist) || !getBits(4, ncode) ) {
+          return false;
+        }
+        nlen += 257;
+        ndist += 1;
+        ncode += 4;
+        if ( nlen > 286 || ndist > 30 ) {
+          return false;
+        }
+        uint8_t lengths[320] = { 0 };
+        for ( uint32_t i = 0; i < ncode; i++ ) {
+          uint32_t len;
+          if ( !getBits(3, len) ) {
+            return false;
+          }
+          lengths[kOrder[i]] = static_cast<uint8_t>(len);
+        }
+        Huffman lencode, distcode;
+        if ( !lencode.build(lengths, 19) ) {
+          return false;
+        }
+        memset(lengths, 0, sizeof(lengths));
+        uint32_t index = 0;
+        while ( index < nlen + ndist ) {
+          int symbol = decode(lencode);
+          if ( symbol < 0 ) {
+            return false;
+          }
+          if ( symbol < 16 ) {
+            lengths[index++] = static_cast<uint8_t>(symbol);
+            continue;
+          }
+          uint8_t len = 0;
+          uint32_t repeat;
+          if ( symbol == 16 ) {
+            if ( index == 0 || !getBits(2, repeat) ) {
+              return false;
+            }
+            len = lengths[index - 1];
+            repeat += 3;
+          }
+          else if ( symbol == 17 ) {
+            if ( !getBits(3, repeat) ) {
+              return false;
+            }
+            repeat += 3;
+          }
+          else {
+            if ( !getBits(7, repeat) ) {
+              return false;
+            }
+            repeat += 11;
+          }
+          if ( index + repeat > nlen + ndist ) {
+            return false;
+          }
+          while ( repeat-- ) {
+            lengths[index++] = len;
+          }
+        }
+        if ( lengths[256] == 0 ) {
+          return false; //no end of block code
+        }
+        if ( !lencode.build(lengths, nlen) || !distcode.build(lengths + nlen, ndist) ) {
+          return false;
+        }
+        return codes(lencode, distcode);
+      }
+
+      bool codes(const Huffman& lencode, const Huffman& distcode) {
+        static const uint16_t kLengthBase[29] = {
+          3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t kLengthExtra[29] = {
+          0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t kDistanceBase[30] = {
+          1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+          8193, 12289, 16385, 24577 };
+        static const uint8_t kDistanceExtra[30] = {
+          0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+          7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        while ( true ) {
+          int symbol = decode(lencode);
+          if ( symbol < 0 ) {
+            return false;
+          }
+          if ( symbol < 256 ) {
+            mOut.push_back(static_cast<char>(symbol));
+            continue;
+          }
+          if ( symbol == 256 ) {
+            return true;
+          }
+          symbol -= 257;
+          if ( symbol >= 29 ) {
+            return false;
+          }
+          uint32_t extra;
+          if ( !getBits(kLengthExtra[symbol], extra) ) {
+            return false;
+          }
+          size_t length = kLengthBase[symbol] + extra;
+          symbol = decode(distcode);
+          if ( symbol < 0 || symbol >= 30 || !getBits(kDistanceExtra[symbol], extra) ) {
+            return false;
+          }
+          size_t distance = kDistanceBase[symbol] + extra;
+          if ( distance > mOut.size() - mStart ) {
+            return false;
+          }
+          //copies may overlap their own output, byte by byte
+          size_t from = mOut.size() - distance;
+          size_t to = mOut.size();
+          mOut.resize(to + length);
+          char* out = mOut.data();
+          for ( size_t i = 0; i < length; i++ ) {
+            out[to + i] = out[from + i];
+          }
+        }
+      }
+
+      const unsigned char* mData;
+      size_t mSize;
+      size_t mPos;
+      uint64_t mBits;
+      unsigned mNumOfBits;
+      std::vector<char>& mOut;
+      size_t mStart;
+    };
+
+    bool equalsNoCase(const std::string& a, const std::string& b) {
+      if ( a.size() != b.size() ) {
+        return false;
+      }
+      for ( size_t i = 0; i < a.size(); i++ ) {
+        if ( tolower(static_cast<unsigned char>(a[i])) !=
+            tolower(static_cast<unsigned char>(b[i])) ) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  uint32_t crc32(const void* data, size_t numOfBytes, uint32_t crc) {
+    static const CrcTable table;
+    auto p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for ( size_t i = 0; i < numOfBytes; i++ ) {
+      crc = table.mValues[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
+
+  bool inflate(const unsigned char* data, size_t numOfBytes, std::vector<char>& out) {
+    Inflater inflater(data, numOfBytes, out);
+    return inflater.run();
+  }
+
+  bool LTCZipWriter::beginEntry(const std::string& name) {
+    if ( mOpen || mFailed || name.size() > 0xffff ) {
+      return false;
+    }
+    Entry entry;
+    entry.mName = name;
+    entry.mCrc = 0;
+    entry.mSize = 0;
+    entry.mOffset = mOffset;
+    mEntries.push_back(entry);
+    mOpen = true;
+
+    //crc & sizes are patched by endEntry
+    unsigned char header[kLocalHeaderSize] = { 0 };
+    putU32(header, kLocalHeaderSignature);
+    putU16(header + 4, kVersion);
+    putU16(header + 6, kUtf8Flag);
+    putU16(header + 12, kDosDate);
+    putU16(header + 26, static_cast<uint16_t>(name.size()));
+    return put(header, sizeof(header)) && put(name.data(), name.size());
+  }
+
+  bool LTCZipWriter::write(const void* data, size_t numOfBytes) {
+    if ( !mOpen ) {
+      return false;
+    }
+    auto& entry = mEntries.back();
+    entry.mCrc = crc32(data, numOfBytes, entry.mCrc);
+    entry.mSize += numOfBytes;
+    if ( entry.mSize > kMaxSize ) {
+      mFailed = true; //would need ZIP64
+      return false;
+    }
+    return put(data, numOfBytes);
+  }
+
+  bool LTCZipWriter::endEntry() {
+    if ( !mOpen || mFailed ) {
+      return false;
+    }
+    mOpen = false;
+    auto& entry = mEntries.back();
+    unsigned char fields[12];
+    putU32(fields, entry.mCrc);
+    putU32(fields + 4, static_cast<uint32_t>(entry.mSize));
+    putU32(fields + 8, static_cast<uint32_t>(entry.mSize));
+    if ( !seekFile(mFile, entry.mOffset + 14) ||
+        fwrite(fields, 1, sizeof(fields), mFile) != sizeof(fields) ||
+        !seekFile(mFile, mOffset) ) {
+      mFailed = true;
+    }
+    return !mFailed;
+  }
+
+  bool LTCZipWriter::finish() {
+    if ( mOpen || mFailed || mEntries.size() > 0xffff ) {
+      return false;
+    }
+    uint64_t directoryOffset = mOffset;
+    for ( auto& entry : mEntries ) {
+      if ( entry.mOffset > kMaxSize ) {
+        return false;
+      }
+      unsigned char header[kCentralHeaderSize] = { 0 };
+      putU32(header, kCentralHeaderSignature);
+      putU16(header + 4, kVersion);
+      putU16(header + 6, kVersion);
+      putU16(header + 8, kUtf8Flag);
+      putU16(header + 14, kDosDate);
+      putU32(header + 16, entry.mCrc);
+      putU32(header + 20, static_cast<uint32_t>(entry.mSize));
+      putU32(header + 24, static_cast<uint32_t>(entry.mSize));
+      putU16(header + 28, static_cast<uint16_t>(entry.mName.size()));
+      putU32(header + 42, static_cast<uint32_t>(entry.mOffset));
+      if ( !put(header, sizeof(header)) || !put(entry.mName.data(), entry.mName.size()) ) {
+        return false;
+      }
+    }
+    if ( mOffset > kMaxSize ) {
+      return false;
+    }
+    unsigned char end[kEndSize] = { 0 };
+    putU32(end, kEndSignature);
+    putU16(end + 8, static_cast<uint16_t>(mEntries.size()));
+    putU16(end + 10, static_cast<uint16_t>(mEntries.size()));
+    putU32(end + 12, static_cast<uint32_t>(mOffset - directoryOffset));
+    putU32(end + 16, static_cast<uint32_t>(directoryOffset));
+    return put(end, sizeof(end));
+  }
+
+  bool LTCZipWriter::put(const void* data, size_t numOfBytes) {
+    if ( mFailed ) {
+      return false;
+    }
+    if ( numOfBytes && fwrite(data, 1, numOfBytes, mFile) != numOfBytes ) {
+      mFailed = true;
+      return false;
+    }
+    mOffset += numOfBytes;
+    return true;
+  }
+
+  LTC_ERROR LTCZipReader::open(const unsigned char* data, size_t numOfBytes) {
+    mData = data;
+    mSize = numOfBytes;
+    mEntries.clear();
+    if ( numOfBytes < kEndSize ) {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE;
+    }
+    //the end record is followed by a comment of at most 64k
+    size_t end = numOfBytes - kEndSize;
+    size_t stop = end > 0xffff ? end - 0xffff : 0;
+    while ( getU32(data + end) != kEndSignature ) {
+      if ( end == stop ) {
+        return LTC_ERROR::LTC_INVALID_ARCHIVE;
+      }
+      end--;
+    }
+    size_t count = getU16(data + end + 10);
+    uint64_t directorySize = getU32(data + end + 12);
+    uint64_t pos = getU32(data + end + 16);
+    if ( getU16(data + end + 4) != 0 || pos + directorySize > end ) {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE; //multi-disk or ZIP64
+    }
+    mEntries.reserve(count);
+    for ( size_t i = 0; i < count; i++ ) {
+      if ( pos + kCentralHeaderSize > end || getU32(data + pos) != kCentralHeaderSignature ) {
+        return LTC_ERROR::LTC_INVALID_ARCHIVE;
+      }
+      const unsigned char* header = data + pos;
+      size_t nameLength = getU16(header + 28);
+      size_t skip = nameLength + getU16(header + 30) + getU16(header + 32);
+      if ( pos + kCentralHeaderSize + skip > end ) {
+        return LTC_ERROR::LTC_INVALID_ARCHIVE;
+      }
+      Entry entry;
+      entry.mName.assign(reinterpret_cast<const char*>(header + kCentralHeaderSize), nameLength);
+      entry.mMethod = getU16(header + 10);
+      entry.mCrc = getU32(header + 16);
+      entry.mCompressedSize = getU32(header + 20);
+      entry.mSize = getU32(header + 24);
+      entry.mOffset = getU32(header + 42);
+      if ( getU16(header + 8) & 1 ) {
+        entry.mMethod = 0xffff; //encrypted, read() refuses it
+      }
+      mEntries.push_back(entry);
+      pos += kCentralHeaderSize + skip;
+    }
+    return LTC_ERROR::OK;
+  }
+
+  const LTCZipReader::Entry* LTCZipReader::find(const std::string& name)const {
+    size_t first = name.find_first_not_of('/');
+    std::string partName = first == std::string::npos ? std::string() : name.substr(first);
+    for ( auto& entry : mEntries ) {
+      if ( equalsNoCase(entry.mName, partName) ) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  LTC_ERROR LTCZipReader::read(const Entry& entry, std::vector<char>& out)const {
+    out.clear();
+    if ( entry.mOffset + kLocalHeaderSize > mSize ||
+        getU32(mData + entry.mOffset) != kLocalHeaderSignature ) {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE;
+    }
+    const unsigned char* header = mData + entry.mOffset;
+    uint64_t first = entry.mOffset + kLocalHeaderSize + getU16(header + 26) + getU16(header + 28);
+    if ( first > mSize || entry.mCompressedSize > mSize - first ) {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE;
+    }
+    const unsigned char* data = mData + first;
+    if ( entry.mMethod == 0 ) {
+      out.assign(data, data + entry.mCompressedSize);
+    }
+    else if ( entry.mMethod == 8 ) {
+      out.reserve(entry.mSize);
+      if ( !inflate(data, entry.mCompressedSize, out) ) {
+        return LTC_ERROR::LTC_INVALID_ARCHIVE;
+      }
+    }
+    else {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE;
+    }
+    if ( out.size() != entry.mSize || crc32(out.data(), out.size()) != entry.mCrc ) {
+      return LTC_ERROR::LTC_INVALID_ARCHIVE;
+    }
+    return LTC_ERROR::OK;
+  }
+
+}//namespace LTC
@@ -0,0 +1,125 @@
+// This file is part of libNTLatticeGraph, a lightweight C++ library
+// for reading/writing XML NTLatticeGraph (.ltcx) files.
+//
+// Copyright (C) 2016 nTopology inc. <www.ntopology.com>
+// All rights reserved.
+// The MIT License(MIT)
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#pragma once
+#include "LTCModel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace LTC {
+
+  //! CRC-32 (ZIP / PNG polynomial) of data, continuing from crc.
+  uint32_t crc32(const void* data, size_t numOfBytes, uint32_t crc = 0);
+
+  //! inflate
+  /*!
+  Decompresses a raw deflate stream (RFC 1951) & appends it to out.
+  Returns false on malformed input or when the stream runs past the end
+  of data.
+  */
+  bool inflate(const unsigned char* data, size_t numOfBytes, std::vector<char>& out);
+
+  //! LTCZipWriter
+  /*!
+  Writes a ZIP archive of stored (uncompressed) entries to a FILE*
+  opened "wb", streaming each entry's data. The sizes & CRC are patched
+  into the local header once an entry is finished, so the file has to be
+  seekable. No ZIP64: entries & the archive must stay below 4 GB, write()
+  fails beyond that. Entries get a fixed 1980-01-01 time stamp so the
+  same content gives the same bytes.
+  */
+  class LTCZipWriter {
+  public:
+    LTCZipWriter(FILE* file) :
+      mFile(file),
+      mOffset(0),
+      mOpen(false),
+      mFailed(false) {}
+
+    bool beginEntry(const std::string& name);
+    bool write(const void* data, size_t numOfBytes);
+    bool endEntry();
+    //! Writes the central directory, the archive is complete after this.
+    bool finish();
+
+  private:
+    struct Entry {
+      std::string mName;
+      uint32_t mCrc;
+      uint64_t mSize;
+      uint64_t mOffset;  //of the local header
+    };
+
+    bool put(const void* data, size_t numOfBytes);
+
+    FILE* mFile;
+    uint64_t mOffset;
+    std::vector<Entry> mEntries;
+    bool mOpen;
+    bool mFailed;
+  };
+
+  //! LTCZipReader
+  /*!
+  Reads the central directory of a ZIP archive held in memory (e.g. an
+  LTCMappedFile) & extracts stored or deflated entries, checking their
+  CRC. No ZIP64, encryption or multi-disk archives.
+  */
+  class LTCZipReader {
+  public:
+    struct Entry {
+      std::string mName;
+      uint16_t mMethod;  //0 stored, 8 deflated
+      uint32_t mCrc;
+      uint64_t mCompressedSize;
+      uint64_t mSize;
+      uint64_t mOffset;  //of the local header
+    };
+
+    LTCZipReader() :
+      mData(nullptr),
+      mSize(0) {}
+
+    //! Reads the central directory, data has to outlive the reader.
+    LTC_ERROR open(const unsigned char* data, size_t numOfBytes);
+
+    const std::vector<Entry>& getEntries()const { return mEntries; }
+    //! Entry by name, case-insensitive like OPC part names; nullptr if missing.
+    const Entry* find(const std::string& name)const;
+    LTC_ERROR read(const Entry& entry, std::vector<char>& out)const;
+
+  private:
+    const unsigned char* mData;
+    size_t mSize;
+    std::vector<Entry> mEntries;
+  };
+
+}//namespace LTC